@@ -0,0 +1,131 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "cstr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#define KEYS	(1 << 20)
+
+
+typedef struct chain_entry {
+	struct chain_entry *next;
+	const char *key;
+	void *value;
+} chain_entry_t;
+
+typedef struct {
+	chain_entry_t **buckets;
+	size_t mask;
+} chain_map_t;
+
+
+uint64_t chain_hash(const char *key)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	while (*key) {
+		hash ^= (unsigned char)*key++;
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+void chain_insert(chain_map_t *map, chain_entry_t *entry, const char *key, void *value)
+{
+	chain_entry_t **bucket = &map->buckets[chain_hash(key) & map->mask];
+	entry->key = key;
+	entry->value = value;
+	entry->next = *bucket;
+	*bucket = entry;
+}
+
+void *chain_find(const chain_map_t *map, const char *key)
+{
+	for (chain_entry_t *entry = map->buckets[chain_hash(key) & map->mask]; entry; entry = entry->next)
+		if (strcmp(entry->key, key) == 0)
+			return entry->value;
+
+	return NULL;
+}
+
+double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+	size_t count = (argc > 1) ? (size_t)strtoull(argv[1], NULL, 10) : KEYS;
+
+	string_t *keys = malloc(count * sizeof(string_t));
+	string_t *misses = malloc(count * sizeof(string_t));
+	chain_entry_t *entries = malloc(count * sizeof(chain_entry_t));
+
+	for (size_t i = 0; i < count; ++i) {
+		keys[i] = cstr_append_fmt(cstr_new(""), "user:%zu:session", i);
+		misses[i] = cstr_append_fmt(cstr_new(""), "user:%zu:absent", i);
+	}
+
+	size_t buckets = 1;
+	while (buckets < count)
+		buckets <<= 1;
+
+	chain_map_t chain = { calloc(buckets, sizeof(chain_entry_t *)), buckets - 1 };
+	cstr_map_t *map = cstr_map_new(count, false, 0);
+	size_t found = 0;
+	double start;
+
+	start = now();
+	for (size_t i = 0; i < count; ++i)
+		chain_insert(&chain, &entries[i], keys[i], keys[i]);
+	double chain_insert_ns = (now() - start) / (double)count;
+
+	start = now();
+	for (size_t i = 0; i < count; ++i)
+		cstr_map_insert(map, keys[i], keys[i]);
+	double map_insert_ns = (now() - start) / (double)count;
+
+	start = now();
+	for (size_t i = 0; i < count; ++i)
+		found += (chain_find(&chain, keys[(i * 7919) % count]) != NULL);
+	double chain_hit_ns = (now() - start) / (double)count;
+
+	start = now();
+	for (size_t i = 0; i < count; ++i)
+		found += cstr_map_find(map, keys[(i * 7919) % count], NULL);
+	double map_hit_ns = (now() - start) / (double)count;
+
+	start = now();
+	for (size_t i = 0; i < count; ++i)
+		found += (chain_find(&chain, misses[i]) != NULL);
+	double chain_miss_ns = (now() - start) / (double)count;
+
+	start = now();
+	for (size_t i = 0; i < count; ++i)
+		found += cstr_map_find(map, misses[i], NULL);
+	double map_miss_ns = (now() - start) / (double)count;
+
+	printf("%zu keys (%zu found)\n", count, found);
+	printf("%-8s %12s %12s\n", "", "chained", "cstr_map");
+	printf("%-8s %9.1f ns %9.1f ns\n", "insert", chain_insert_ns, map_insert_ns);
+	printf("%-8s %9.1f ns %9.1f ns\n", "hit", chain_hit_ns, map_hit_ns);
+	printf("%-8s %9.1f ns %9.1f ns\n", "miss", chain_miss_ns, map_miss_ns);
+
+	cstr_map_destroy(map);
+	for (size_t i = 0; i < count; ++i) {
+		cstr_destroy(keys[i]);
+		cstr_destroy(misses[i]);
+	}
+
+	free(chain.buckets);
+	free(entries);
+	free(misses);
+	free(keys);
+
+	return 0;
+}
@@ -0,0 +1,75 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "cstr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CALLS	1000000
+#define NEEDLE	4
+
+
+double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+	static const size_t tails[] = { 0, 64, 4096, 1 << 20 };
+	static const char *names[] = {
+		"find_n", "rfind_n", "find_first_of_n", "find_first_not_of_n",
+		"find_last_not_of_n", "compare_n", "compare_n_ext",
+	};
+
+	size_t calls = (argc > 1) ? (size_t)strtoull(argv[1], NULL, 10) : CALLS;
+	size_t sink = 0;
+
+	string_t string = cstr_new("");
+	for (size_t i = 0; i < 16; ++i)
+		string = cstr_append(string, "the quick brown fox jumps over ");
+	string = cstr_append(string, "xyz!");
+
+	printf("%-20s", "tail bytes");
+	for (size_t t = 0; t < sizeof(tails) / sizeof(tails[0]); ++t)
+		printf(" %12zu", tails[t]);
+	printf("\n");
+
+	for (size_t f = 0; f < sizeof(names) / sizeof(names[0]); ++f) {
+		printf("%-20s", names[f]);
+
+		for (size_t t = 0; t < sizeof(tails) / sizeof(tails[0]); ++t) {
+			char *argument = malloc(NEEDLE + tails[t] + 1);
+			memcpy(argument, "xyz!", NEEDLE);
+			memset(argument + NEEDLE, 'q', tails[t]);
+			argument[NEEDLE + tails[t]] = '\0';
+
+			double start = now();
+			for (size_t i = 0; i < calls; ++i) {
+				switch (f) {
+				case 0: sink += cstr_find_n(string, argument, 0, NEEDLE); break;
+				case 1: sink += cstr_rfind_n(string, argument, CSTR_NPOS, NEEDLE); break;
+				case 2: sink += cstr_find_first_of_n(string, argument, 0, NEEDLE); break;
+				case 3: sink += cstr_find_first_not_of_n(string, argument, 0, NEEDLE); break;
+				case 4: sink += cstr_find_last_not_of_n(string, argument, 0, NEEDLE); break;
+				case 5: sink += (size_t)cstr_compare_n(string, argument, NEEDLE); break;
+				default: sink += (size_t)cstr_compare_n_ext(string, cstr_size(string) - NEEDLE, NEEDLE, argument, NEEDLE); break;
+				}
+			}
+
+			printf(" %9.1f ns", (now() - start) / (double)calls);
+			free(argument);
+		}
+
+		printf("\n");
+	}
+
+	printf("(checksum %zu)\n", sink);
+
+	cstr_destroy(string);
+	return 0;
+}
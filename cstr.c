@@ -1,1281 +1,7107 @@
+#if	defined(__linux__) && !defined(_GNU_SOURCE)
+#	define	_GNU_SOURCE
+#endif
+
 #include "cstr.h"
 
+#include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 #include <limits.h>
+#include <stdint.h>
 #include <assert.h>
 
-#define CSTR_DEFAULT_CAPACITY	10
+#include <stdatomic.h>
 
-#if	defined(_MSC_VER)
-#	pragma	warning	(disable : 4996)
-#	define	_CRT_SECURE_NO_WARNINGS
+#if	defined(__GLIBC__) || defined(__linux__)
+#include <malloc.h>
+#elif	defined(__APPLE__)
+#include <malloc/malloc.h>
 #endif
 
+#if	defined(__GNUC__) && defined(__SSE2__)
+#include <immintrin.h>
+#	define	CSTR_HAS_SSE2
+#endif
 
-typedef struct string_header_t
-{
-	size_t	_size;
-	size_t	_capacity;
+#if	defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#	define	CSTR_HAS_MMAP
+#endif
 
-	void *	_begin;
-	void *	_end;
-}
-string_header_t;
+#if	defined(CSTR_POOL)
+#	if	defined(_WIN32)
+#include <windows.h>
+#	else
+#include <pthread.h>
+#	endif
+#endif
 
+#define CSTR_DEFAULT_CAPACITY	10
 
-string_header_t *
-_cstr_header
-(string_t string)
-{
-	return (string_header_t *)(string - sizeof(string_header_t));
-}
+#define CSTR_DEFAULT_GROWTH_FACTOR	2.0
+#define CSTR_DEFAULT_PAGE_SIZE		4096
+#define CSTR_DEFAULT_MMAP_THRESHOLD	(4u << 20)
 
-string_t
-_cstr_expand
-(string_t string, const size_t size)
-{
-	string_header_t *header = _cstr_header(string);
+#define CSTR_SEARCH_MIN_FAILURES	16
 
-	size_t new_capacity = header->_capacity;
-	while (new_capacity < size)
-		new_capacity <<= 1;
+#define CSTR_REPLACE_STACK_POSITIONS	256
 
-	size_t realloc_size = sizeof(string_header_t) + new_capacity;
-	void *new_string = realloc(header, realloc_size);
-	assert(new_string && "failed to resize string and allocate memory!");
+#define CSTR_EDIT_SORT_RUN	16
 
-	string_header_t *new_header = new_string;
-	new_header->_capacity = new_capacity;
-	new_header->_size = size;
-	new_header->_begin = (string_t)new_string + sizeof(string_header_t);
-	new_header->_end = (string_t)(new_header->_begin) + (size - 1);
+#define CSTR_ROPE_CHUNK		1024
 
-	return (new_header->_begin);
-}
+#define CSTR_GAP_DEFAULT_CAPACITY	64
 
-bool
-_cstr_invalid
-(string_t string)
-{
-	string_header_t *header = _cstr_header(string);
-	return (header->_capacity == 0) && (header->_begin == NULL);
-}
+#define CSTR_SPLIT_WINDOW	256
 
+#define CSTR_TEDDY_MAX_PATTERNS		32
+#define CSTR_TEDDY_BUCKETS			8
+#define CSTR_TEDDY_FINGERPRINT		3
+#define CSTR_MULTIMATCHER_SKIP_MAX	32
 
-string_t
-cstr_new
-(const char *string)
-{
-	assert(string && "string argument must be valid!");
+#define CSTR_HASH_PREFETCH_DISTANCE	8
 
-	size_t length = strlen(string);
+#if	!defined(CSTR_INTERN_SHARDS)
+#define CSTR_INTERN_SHARDS	64
+#endif
 
-	size_t capacity = CSTR_DEFAULT_CAPACITY;
-	while (capacity < length)
-		capacity <<= 1;
+#define CSTR_INTERN_MIN_SLOTS	16
 
-	size_t alloc_size = sizeof(string_header_t) + capacity;
+#define CSTR_MAP_GROUP			16
+#define CSTR_MAP_MIN_CAPACITY	16
+#define CSTR_MAP_EMPTY			((int8_t)-128)
+#define CSTR_MAP_DELETED		((int8_t)-2)
 
-	void *new_string = malloc(alloc_size);
-	assert(new_string && "failed to allocate new string!");
+#define CSTR_ARENA_DEFAULT_CHUNK	4096
+#define CSTR_ARENA_ALIGN			sizeof(void *)
+#define CSTR_ARENA_ALIGN_UP(n)		(((n) + (CSTR_ARENA_ALIGN - 1)) & ~(CSTR_ARENA_ALIGN - 1))
 
-	string_header_t *header = new_string;
-	header->_size = length;
-	header->_capacity = capacity;
+#if	!defined(CSTR_POOL_MAGAZINE_SIZE)
+#define CSTR_POOL_MAGAZINE_SIZE	32
+#endif
 
-	header->_begin = (string_t)(header)+sizeof(string_header_t);
-	strcpy(header->_begin, string);
+#if	!defined(CSTR_POOL_DEPOT_SIZE)
+#define CSTR_POOL_DEPOT_SIZE	16
+#endif
 
-	header->_end = (string_t)header->_begin + (header->_size - 1);
+#if	!defined(CSTR_POOL_HIGH_WATER)
+#define CSTR_POOL_HIGH_WATER	(8u << 20)
+#endif
 
-	return (header->_begin);
-}
+#define CSTR_POOL_MIN_SHIFT		4
+#define CSTR_POOL_CLASSES		9
 
-string_t
-cstr_reserve
-(const size_t capacity)
-{
-	assert((capacity > 0) && "capacity must be greater than zero!");
+#define CSTR_TYPE_8		0x00
+#define CSTR_TYPE_16	0x01
+#define CSTR_TYPE_32	0x02
+#define CSTR_TYPE_64	0x03
+#define CSTR_TYPE_MASK	0x03
+
+#define CSTR_FLAG_ALLOCATOR	0x04
+#define CSTR_FLAG_MMAP		0x08
+#define CSTR_FLAG_BUFFER	0x10
+#define CSTR_FLAG_STATIC	0x20
+#define CSTR_FLAG_SHARED	0x40
 
-	size_t alloc_size = sizeof(string_header_t) + capacity;
+#if	defined(_MSC_VER)
+#	pragma	warning	(disable : 4996)
+#	define	_CRT_SECURE_NO_WARNINGS
+#	define	CSTR_THREAD_LOCAL	__declspec(thread)
+#else
+#	define	CSTR_THREAD_LOCAL	_Thread_local
+#endif
 
-	void *new_string = malloc(alloc_size);
-	assert(new_string && "failed to allocate new string!");
 
-	string_header_t *header = new_string;
-	header->_size = 0;
-	header->_capacity = capacity;
-	header->_begin = (string_t)(header)+sizeof(string_header_t);
-	header->_end = (string_t)header->_begin + (header->_size - 1);
+#pragma pack(push, 1)
 
-	memset(header->_begin, 0, header->_size);
+typedef struct string_header8_t
+{
+	uint8_t		_size;
+	uint8_t		_capacity;
+	uint8_t		_flags;
+}
+string_header8_t;
 
-	return (header->_begin);
+typedef struct string_header16_t
+{
+	uint16_t	_size;
+	uint16_t	_capacity;
+	uint8_t		_flags;
 }
+string_header16_t;
 
-void
-cstr_destroy
-(string_t string)
+typedef struct string_header32_t
 {
-	string_header_t *header = _cstr_header(string);
-	assert(header && "failed to locate header address!");
+	uint32_t	_size;
+	uint32_t	_capacity;
+	uint8_t		_flags;
+}
+string_header32_t;
 
-	free(header);
+typedef struct string_header64_t
+{
+	uint64_t	_size;
+	uint64_t	_capacity;
+	uint8_t		_flags;
 }
+string_header64_t;
 
+#pragma pack(pop)
 
-void
-cstr_clear
-(string_t string)
+typedef struct cstr_shared_t
 {
-	string_header_t *header = _cstr_header(string);
-	memset(header->_begin, 0, header->_size);
-	header->_size = 0;
+	atomic_uint_least64_t	_hash;
+	atomic_uint_least64_t	_seed;
+	atomic_uint				_hash_seq;
+	atomic_uint				_refs;
 }
+cstr_shared_t;
 
-string_t
-cstr_shrink_to_fit
+_Static_assert(sizeof(string_header32_t) == 9, "literal headers must match string_header32_t!");
+_Static_assert(CSTR_LITERAL_FLAGS == (CSTR_TYPE_32 | CSTR_FLAG_STATIC), "literal flags must match header flags!");
+
+
+uint8_t
+_cstr_flags
 (string_t string)
 {
-	string_header_t *old_header = _cstr_header(string);
-	size_t size = old_header->_size;
+	return ((uint8_t *)string)[-1];
+}
 
-	size_t realloc_size = sizeof(string_header_t) + (size + 1);
-	void *new_string = realloc(old_header, realloc_size);
-	assert(new_string && "failed to shrink string to fit!");
+uint8_t
+_cstr_type
+(string_t string)
+{
+	return (_cstr_flags(string) & CSTR_TYPE_MASK);
+}
 
-	string_header_t *new_header = new_string;
-	new_header->_capacity = size;
+uint8_t
+_cstr_type_for
+(size_t capacity)
+{
+	if (capacity <= UINT8_MAX)
+		return CSTR_TYPE_8;
+	if (capacity <= UINT16_MAX)
+		return CSTR_TYPE_16;
+	if ((uint64_t)capacity <= UINT32_MAX)
+		return CSTR_TYPE_32;
+
+	return CSTR_TYPE_64;
+}
 
-	new_header->_begin = (string_t)(new_header)+sizeof(string_header_t);
-	new_header->_end = (string_t)(new_header->_begin) + (size - 1);
+size_t
+_cstr_header_size
+(uint8_t type)
+{
+	switch (type & CSTR_TYPE_MASK) {
+	case CSTR_TYPE_8:	return sizeof(string_header8_t);
+	case CSTR_TYPE_16:	return sizeof(string_header16_t);
+	case CSTR_TYPE_32:	return sizeof(string_header32_t);
+	default:			return sizeof(string_header64_t);
+	}
+}
 
-	((char *)new_header->_end)[1] = '\0';
-	return (new_header->_begin);
+void *
+_cstr_header
+(string_t string)
+{
+	return (string - _cstr_header_size(_cstr_type(string)));
 }
 
-void
-cstr_resize
-(string_t string, size_t n, char c)
+size_t
+_cstr_get_size
+(string_t string)
 {
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
+	void *header = _cstr_header(string);
 
-	if (n > header->_capacity) {
-		string = _cstr_expand(string, n);
-		header = _cstr_header(string);
+	switch (_cstr_type(string)) {
+	case CSTR_TYPE_8:	return ((string_header8_t *)header)->_size;
+	case CSTR_TYPE_16:	return ((string_header16_t *)header)->_size;
+	case CSTR_TYPE_32:	return ((string_header32_t *)header)->_size;
+	default:			return (size_t)((string_header64_t *)header)->_size;
+	}
+}
 
-		for (size_t i = old_size; i < header->_size; ++i)
-			((char *)header->_begin)[i] = c;
+size_t
+_cstr_get_capacity
+(string_t string)
+{
+	void *header = _cstr_header(string);
 
-		((char *)header->_end)[1] = '\0';
-	}
-	else {
-		header->_size = n;
-		header->_end = (string_t)(header->_begin) + (n - 1);
-		((char *)header->_end)[1] = '\0';
+	switch (_cstr_type(string)) {
+	case CSTR_TYPE_8:	return ((string_header8_t *)header)->_capacity;
+	case CSTR_TYPE_16:	return ((string_header16_t *)header)->_capacity;
+	case CSTR_TYPE_32:	return ((string_header32_t *)header)->_capacity;
+	default:			return (size_t)((string_header64_t *)header)->_capacity;
 	}
 }
 
-string_t
-cstr_append
-(string_t string, const char *append_str)
+void
+_cstr_set_size
+(string_t string, size_t size)
 {
-	assert(append_str && "append_str argument must be valid!");
-
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t append_length = strlen(append_str);
-	size_t new_size = old_size + append_length;
+	void *header = _cstr_header(string);
 
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
-	}
-	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
+	switch (_cstr_type(string)) {
+	case CSTR_TYPE_8:	((string_header8_t *)header)->_size = (uint8_t)size;	break;
+	case CSTR_TYPE_16:	((string_header16_t *)header)->_size = (uint16_t)size;	break;
+	case CSTR_TYPE_32:	((string_header32_t *)header)->_size = (uint32_t)size;	break;
+	default:			((string_header64_t *)header)->_size = (uint64_t)size;	break;
 	}
 
-	memcpy((char *)header->_begin + old_size, append_str, append_length);
-
-	((char *)header->_end)[1] = '\0';
-	return (header->_begin);
+	string[size] = '\0';
 }
 
 string_t
-cstr_append_n
-(string_t string, const char *append_str, size_t n)
+_cstr_init_header
+(void *header, uint8_t flags, size_t size, size_t capacity)
 {
-	assert(append_str && "append_str argument must be valid!");
-	assert((n <= strlen(append_str)) && "n should be less than or equal to length of append_str!");
-
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t new_size = old_size + n;
-
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
+	switch (flags & CSTR_TYPE_MASK) {
+	case CSTR_TYPE_8: {
+		string_header8_t *h = header;
+		h->_size = (uint8_t)size;
+		h->_capacity = (uint8_t)capacity;
+		h->_flags = flags;
+		break;
+	}
+	case CSTR_TYPE_16: {
+		string_header16_t *h = header;
+		h->_size = (uint16_t)size;
+		h->_capacity = (uint16_t)capacity;
+		h->_flags = flags;
+		break;
+	}
+	case CSTR_TYPE_32: {
+		string_header32_t *h = header;
+		h->_size = (uint32_t)size;
+		h->_capacity = (uint32_t)capacity;
+		h->_flags = flags;
+		break;
+	}
+	default: {
+		string_header64_t *h = header;
+		h->_size = (uint64_t)size;
+		h->_capacity = (uint64_t)capacity;
+		h->_flags = flags;
+		break;
 	}
-	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
 	}
 
-	for (size_t i = 0; i < n; ++i)
-		((char *)header->_begin)[old_size + i] = append_str[i];
+	return ((string_t)header + _cstr_header_size(flags));
+}
 
-	((char *)header->_end)[1] = '\0';
-	return (header->_begin);
+void *
+_cstr_libc_alloc
+(void *context, size_t size)
+{
+	(void)context;
+	return malloc(size);
 }
 
-string_t
-cstr_append_string
-(string_t string, const string_t append_str)
+void *
+_cstr_libc_realloc
+(void *context, void *ptr, size_t old_size, size_t new_size)
 {
-	assert(append_str && "append_str argument must be valid!");
+	(void)context;
+	(void)old_size;
+	return realloc(ptr, new_size);
+}
 
-	return cstr_append(string, cstr_data(append_str));
+void
+_cstr_libc_free
+(void *context, void *ptr, size_t size)
+{
+	(void)context;
+	(void)size;
+	free(ptr);
 }
 
-string_t
-cstr_append_substring
-(string_t string, const string_t append_str, size_t subpos, size_t sublen)
+size_t
+_cstr_libc_usable_size
+(void *context, void *ptr, size_t size)
 {
-	assert(append_str && "append_str argument must be valid!");
+	(void)context;
+
+#if	defined(__GLIBC__) || defined(__linux__)
+	(void)size;
+	return malloc_usable_size(ptr);
+#elif	defined(__APPLE__)
+	(void)size;
+	return malloc_size(ptr);
+#elif	defined(_MSC_VER)
+	(void)size;
+	return _msize(ptr);
+#else
+	(void)ptr;
+	return size;
+#endif
+}
 
-	size_t length = cstr_length(append_str);
-	if (subpos < length) {
-		size_t actual_sublen = ((sublen > (length - subpos)) ? (length - subpos) : sublen);
-		return cstr_append_n(string, cstr_data(append_str) + subpos, actual_sublen);
-	}
 
-	return string;
+#if	defined(CSTR_POOL)
+
+typedef struct cstr_pool_magazine_t
+{
+	size_t	_count;
+	void *	_blocks[CSTR_POOL_MAGAZINE_SIZE];
 }
+cstr_pool_magazine_t;
 
-string_t
-cstr_append_fill
-(string_t string, size_t n, char c)
+typedef struct cstr_pool_depot_t
 {
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t new_size = old_size + n;
+	atomic_int				_lock;
+	size_t					_count;
+	cstr_pool_magazine_t	_magazines[CSTR_POOL_DEPOT_SIZE];
+}
+cstr_pool_depot_t;
 
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
-	}
-	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
-	}
+CSTR_THREAD_LOCAL cstr_pool_magazine_t _cstr_pool_magazines[CSTR_POOL_CLASSES];
+CSTR_THREAD_LOCAL bool _cstr_pool_registered;
 
-	for (size_t i = old_size; i < new_size; ++i)
-		((char *)header->_begin)[i] = c;
+#if	defined(_WIN32)
+INIT_ONCE _cstr_pool_once = INIT_ONCE_STATIC_INIT;
+DWORD _cstr_pool_key = FLS_OUT_OF_INDEXES;
+#else
+pthread_once_t _cstr_pool_once = PTHREAD_ONCE_INIT;
+pthread_key_t _cstr_pool_key;
+#endif
 
-	((char *)header->_end)[1] = '\0';
-	return (header->_begin);
-}
+cstr_pool_depot_t _cstr_pool_depots[CSTR_POOL_CLASSES];
 
-string_t
-cstr_append_range
-(string_t string, const void *start, const void *end)
+atomic_size_t _cstr_pool_cached_bytes;
+atomic_size_t _cstr_pool_high_water = CSTR_POOL_HIGH_WATER;
+
+
+size_t
+_cstr_pool_class
+(size_t size)
 {
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t new_size = old_size + (ptrdiff_t)((char *)end - (char *)start);
+	size_t index = 0;
+	size_t class_size = ((size_t)1 << CSTR_POOL_MIN_SHIFT);
 
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
-	}
-	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
+	while (class_size < size) {
+		class_size <<= 1;
+		++index;
 	}
 
-	char *itr = (char *)start;
-	for (size_t i = 0; itr <= (char *)end; ++itr, ++i)
-		((char *)header->_begin)[old_size + i] = *itr;
+	return index;
+}
 
-	return (header->_begin);
+size_t
+_cstr_pool_class_size
+(size_t index)
+{
+	return ((size_t)1 << (index + CSTR_POOL_MIN_SHIFT));
 }
 
 void
-cstr_push_back
-(string_t string, char c)
+_cstr_pool_lock
+(cstr_pool_depot_t *depot)
 {
-	string_header_t *header = _cstr_header(string);
-	if (header->_size >= header->_capacity) {
-		string = _cstr_expand(string, header->_size + 1);
-		header = _cstr_header(string);
-	}
-	else {
-		header->_size++;
-		header->_end = (string_t)(header->_begin) + (header->_size - 1);
-	}
+	int expected = 0;
+	while (!atomic_compare_exchange_weak_explicit(&depot->_lock, &expected, 1, memory_order_acquire, memory_order_relaxed))
+		expected = 0;
+}
 
-	((char *)header->_end)[0] = c;
-	((char *)header->_end)[1] = '\0';
+void
+_cstr_pool_unlock
+(cstr_pool_depot_t *depot)
+{
+	atomic_store_explicit(&depot->_lock, 0, memory_order_release);
 }
 
 void
-cstr_pop_back
-(string_t string)
+_cstr_pool_release
+(cstr_pool_magazine_t *magazine, size_t index)
 {
-	string_header_t *header = _cstr_header(string);
-	header->_size--;
-	header->_end = (string_t)(header->_begin) + (header->_size - 1);
+	for (size_t i = 0; i < magazine->_count; ++i)
+		free(magazine->_blocks[i]);
 
-	((char *)header->_end)[1] = '\0';
+	atomic_fetch_sub_explicit(&_cstr_pool_cached_bytes, magazine->_count * _cstr_pool_class_size(index), memory_order_relaxed);
+	magazine->_count = 0;
 }
 
-string_t
-cstr_assign
-(string_t string, const char *assign_str)
+void
+_cstr_pool_refill
+(cstr_pool_magazine_t *magazine, size_t index)
 {
-	assert(assign_str && "assign_str argument must be valid!");
+	cstr_pool_depot_t *depot = &_cstr_pool_depots[index];
 
-	cstr_clear(string);
-	return cstr_append(string, assign_str);
+	_cstr_pool_lock(depot);
+	if (depot->_count > 0)
+		*magazine = depot->_magazines[--depot->_count];
+	_cstr_pool_unlock(depot);
 }
 
-string_t
-cstr_assign_n
-(string_t string, const char *assign_str, size_t n)
+void
+_cstr_pool_spill
+(cstr_pool_magazine_t *magazine, size_t index)
 {
-	assert(assign_str && "assign_str argument must be valid!");
+	cstr_pool_depot_t *depot = &_cstr_pool_depots[index];
+	bool stored = false;
 
-	cstr_clear(string);
-	return cstr_append_n(string, assign_str, n);
+	_cstr_pool_lock(depot);
+	if (depot->_count < CSTR_POOL_DEPOT_SIZE) {
+		depot->_magazines[depot->_count++] = *magazine;
+		stored = true;
+	}
+	_cstr_pool_unlock(depot);
+
+	if (stored)
+		magazine->_count = 0;
+	else
+		_cstr_pool_release(magazine, index);
 }
 
-string_t
-cstr_assign_string
-(string_t string, const string_t assign_str)
+#if	defined(_WIN32)
+
+void WINAPI
+_cstr_pool_thread_exit
+(void *value)
 {
-	assert(assign_str && "assign_str argument must be valid!");
+	if (value) {
+		_cstr_pool_registered = false;
+		cstr_pool_thread_flush();
+	}
+}
 
-	cstr_clear(string);
-	return cstr_append_string(string, assign_str);
+BOOL CALLBACK
+_cstr_pool_key_init
+(INIT_ONCE *once, void *parameter, void **context)
+{
+	(void)once;
+	(void)parameter;
+	(void)context;
+
+	_cstr_pool_key = FlsAlloc(_cstr_pool_thread_exit);
+	return TRUE;
 }
 
-string_t
-cstr_assign_substring
-(string_t string, const string_t assign_str, size_t subpos, size_t sublen)
+void
+_cstr_pool_register
+(void)
 {
-	assert(assign_str && "assign_str argument must be valid!");
+	InitOnceExecuteOnce(&_cstr_pool_once, _cstr_pool_key_init, NULL, NULL);
+	if (_cstr_pool_key != FLS_OUT_OF_INDEXES)
+		FlsSetValue(_cstr_pool_key, &_cstr_pool_registered);
 
-	cstr_clear(string);
-	return cstr_append_substring(string, assign_str, subpos, sublen);
+	_cstr_pool_registered = true;
 }
 
-string_t
-cstr_assign_fill
-(string_t string, size_t n, char c)
+#else
+
+void
+_cstr_pool_thread_exit
+(void *value)
 {
-	cstr_clear(string);
-	return cstr_append_fill(string, n, c);
+	(void)value;
+
+	_cstr_pool_registered = false;
+	cstr_pool_thread_flush();
 }
 
-string_t
-cstr_assign_range
-(string_t string, const void *start, const void *end)
+void
+_cstr_pool_key_init
+(void)
 {
-	cstr_clear(string);
-	return cstr_append_range(string, start, end);
+	int result = pthread_key_create(&_cstr_pool_key, _cstr_pool_thread_exit);
+	assert((result == 0) && "failed to create pool thread key!");
+	(void)result;
 }
 
-string_t
-cstr_insert
-(string_t string, size_t pos, const char *insert_str)
+void
+_cstr_pool_register
+(void)
 {
-	assert(insert_str && "insert_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "pos argument is out of range!");
+	pthread_once(&_cstr_pool_once, _cstr_pool_key_init);
+	pthread_setspecific(_cstr_pool_key, &_cstr_pool_registered);
 
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t insert_length = strlen(insert_str);
-	size_t new_size = old_size + insert_length;
+	_cstr_pool_registered = true;
+}
 
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
-	}
-	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
-	}
+#endif
 
-	size_t move_size = old_size - pos;
-	memmove(
-		(string_t)(header->_begin) + (pos + insert_length),
-		(string_t)(header->_begin) + pos,
-		move_size
-	);
+void *
+_cstr_pool_alloc
+(void *context, size_t size)
+{
+	(void)context;
+
+	size_t index = _cstr_pool_class(size);
+	if (index >= CSTR_POOL_CLASSES)
+		return malloc(size);
+
+	cstr_pool_magazine_t *magazine = &_cstr_pool_magazines[index];
+	if (magazine->_count == 0)
+		_cstr_pool_refill(magazine, index);
 
-	memcpy((string_t)(header->_begin) + pos, insert_str, insert_length);
+	if (magazine->_count > 0) {
+		atomic_fetch_sub_explicit(&_cstr_pool_cached_bytes, _cstr_pool_class_size(index), memory_order_relaxed);
+		return magazine->_blocks[--magazine->_count];
+	}
 
-	((char *)header->_end)[1] = '\0';
-	return (header->_begin);
+	return malloc(_cstr_pool_class_size(index));
 }
 
-string_t
-cstr_insert_n
-(string_t string, size_t pos, const char *insert_str, size_t n)
+void
+_cstr_pool_free
+(void *context, void *ptr, size_t size)
 {
-	assert(insert_str && "insert_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "pos argument is out of range!");
+	(void)context;
 
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t new_size = old_size + n;
+	if (!ptr)
+		return;
 
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
+	size_t index = _cstr_pool_class(size);
+	if (index >= CSTR_POOL_CLASSES) {
+		free(ptr);
+		return;
 	}
-	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
+
+	size_t class_size = _cstr_pool_class_size(index);
+	size_t cached = atomic_load_explicit(&_cstr_pool_cached_bytes, memory_order_relaxed);
+	if (cached + class_size > atomic_load_explicit(&_cstr_pool_high_water, memory_order_relaxed)) {
+		free(ptr);
+		return;
 	}
 
-	size_t move_size = old_size - pos;
-	memmove(
-		(string_t)(header->_begin) + (pos + n),
-		(string_t)(header->_begin) + pos,
-		move_size
-	);
+	if (!_cstr_pool_registered)
+		_cstr_pool_register();
 
-	memcpy((string_t)(header->_begin) + pos, insert_str, n);
+	cstr_pool_magazine_t *magazine = &_cstr_pool_magazines[index];
+	if (magazine->_count == CSTR_POOL_MAGAZINE_SIZE)
+		_cstr_pool_spill(magazine, index);
 
-	((char *)header->_end)[1] = '\0';
-	return (header->_begin);
+	magazine->_blocks[magazine->_count++] = ptr;
+	atomic_fetch_add_explicit(&_cstr_pool_cached_bytes, class_size, memory_order_relaxed);
 }
 
-string_t
-cstr_insert_string
-(string_t string, size_t pos, const string_t insert_str)
+void *
+_cstr_pool_realloc
+(void *context, void *ptr, size_t old_size, size_t new_size)
 {
-	assert(insert_str && "insert_str argument must be valid!");
+	size_t old_index = _cstr_pool_class(old_size);
+	size_t new_index = _cstr_pool_class(new_size);
 
-	return cstr_insert(string, pos, cstr_data(insert_str));
-}
+	if (old_index == new_index && old_index < CSTR_POOL_CLASSES)
+		return ptr;
+
+	if (old_index >= CSTR_POOL_CLASSES && new_index >= CSTR_POOL_CLASSES)
+		return realloc(ptr, new_size);
+
+	void *new_ptr = _cstr_pool_alloc(context, new_size);
+	if (new_ptr) {
+		memcpy(new_ptr, ptr, (old_size < new_size) ? old_size : new_size);
+		_cstr_pool_free(context, ptr, old_size);
+	}
+
+	return new_ptr;
+}
+
+size_t
+_cstr_pool_usable_size
+(void *context, void *ptr, size_t size)
+{
+	size_t index = _cstr_pool_class(size);
+	if (index >= CSTR_POOL_CLASSES)
+		return _cstr_libc_usable_size(context, ptr, size);
+
+	return _cstr_pool_class_size(index);
+}
+
+
+void
+cstr_pool_set_high_water
+(size_t bytes)
+{
+	atomic_store_explicit(&_cstr_pool_high_water, bytes, memory_order_relaxed);
+}
+
+size_t
+cstr_pool_cached
+(void)
+{
+	return atomic_load_explicit(&_cstr_pool_cached_bytes, memory_order_relaxed);
+}
+
+void
+cstr_pool_thread_flush
+(void)
+{
+	for (size_t index = 0; index < CSTR_POOL_CLASSES; ++index)
+		if (_cstr_pool_magazines[index]._count > 0)
+			_cstr_pool_spill(&_cstr_pool_magazines[index], index);
+}
+
+void
+cstr_pool_trim
+(void)
+{
+	for (size_t index = 0; index < CSTR_POOL_CLASSES; ++index) {
+		_cstr_pool_release(&_cstr_pool_magazines[index], index);
+
+		cstr_pool_depot_t *depot = &_cstr_pool_depots[index];
+
+		_cstr_pool_lock(depot);
+		while (depot->_count > 0)
+			_cstr_pool_release(&depot->_magazines[--depot->_count], index);
+		_cstr_pool_unlock(depot);
+	}
+}
+
+const cstr_allocator_t _cstr_default_allocator = {
+	_cstr_pool_alloc,
+	_cstr_pool_realloc,
+	_cstr_pool_free,
+	NULL,
+	_cstr_pool_usable_size
+};
+
+#else
+
+const cstr_allocator_t _cstr_default_allocator = {
+	_cstr_libc_alloc,
+	_cstr_libc_realloc,
+	_cstr_libc_free,
+	NULL,
+	_cstr_libc_usable_size
+};
+
+#endif
+
+const cstr_allocator_t *_cstr_global_allocator = &_cstr_default_allocator;
+
+cstr_policy_t _cstr_policy = {
+	CSTR_DEFAULT_GROWTH_FACTOR,
+	0,
+	CSTR_DEFAULT_PAGE_SIZE,
+	true,
+	0.0,
+	CSTR_DEFAULT_MMAP_THRESHOLD,
+	false
+};
+
+
+size_t
+_cstr_prefix_size
+(uint8_t flags)
+{
+	size_t size = ((flags & CSTR_FLAG_ALLOCATOR) ? sizeof(const cstr_allocator_t *) : 0);
+
+	return (size + ((flags & CSTR_FLAG_SHARED) ? sizeof(cstr_shared_t) : 0));
+}
+
+cstr_shared_t *
+_cstr_shared
+(string_t string)
+{
+	return (cstr_shared_t *)((char *)_cstr_header(string) - sizeof(cstr_shared_t));
+}
+
+atomic_uint *
+_cstr_refcount
+(string_t string)
+{
+	return &_cstr_shared(string)->_refs;
+}
+
+void
+_cstr_init_shared
+(string_t string)
+{
+	cstr_shared_t *shared = _cstr_shared(string);
+
+	atomic_init(&shared->_hash, 0);
+	atomic_init(&shared->_seed, 0);
+	atomic_init(&shared->_hash_seq, 0u);
+	atomic_init(&shared->_refs, 1u);
+}
+
+bool
+_cstr_is_shared
+(string_t string)
+{
+	return (_cstr_flags(string) & CSTR_FLAG_SHARED) && (atomic_load_explicit(_cstr_refcount(string), memory_order_acquire) > 1);
+}
+
+void
+_cstr_invalidate_hash
+(string_t string)
+{
+	if (_cstr_flags(string) & CSTR_FLAG_SHARED)
+		atomic_store_explicit(&_cstr_shared(string)->_hash_seq, 0u, memory_order_relaxed);
+}
+
+char *
+_cstr_block
+(string_t string)
+{
+	return ((char *)_cstr_header(string) - _cstr_prefix_size(_cstr_flags(string)));
+}
+
+size_t
+_cstr_block_size
+(string_t string)
+{
+	uint8_t flags = _cstr_flags(string);
+	return (_cstr_prefix_size(flags) + _cstr_header_size(flags) + _cstr_get_capacity(string) + 1);
+}
+
+const cstr_allocator_t *
+_cstr_allocator_of
+(string_t string)
+{
+	if (!(_cstr_flags(string) & CSTR_FLAG_ALLOCATOR))
+		return &_cstr_default_allocator;
+
+	const cstr_allocator_t *allocator;
+	memcpy(&allocator, _cstr_block(string), sizeof(allocator));
+	return allocator;
+}
+
+void *
+_cstr_temp_alloc
+(size_t size)
+{
+	const cstr_allocator_t *allocator = _cstr_global_allocator;
+
+	void *ptr = allocator->alloc(allocator->context, size);
+	assert(ptr && "failed to allocate temporary buffer!");
+
+	return ptr;
+}
+
+void
+_cstr_temp_free
+(void *ptr, size_t size)
+{
+	const cstr_allocator_t *allocator = _cstr_global_allocator;
+	allocator->free(allocator->context, ptr, size);
+}
+
+size_t
+_cstr_type_max
+(uint8_t type)
+{
+	switch (type & CSTR_TYPE_MASK) {
+	case CSTR_TYPE_8:	return UINT8_MAX;
+	case CSTR_TYPE_16:	return UINT16_MAX;
+	case CSTR_TYPE_32:	return (size_t)UINT32_MAX;
+	default:			return SIZE_MAX;
+	}
+}
+
+size_t
+_cstr_harvest
+(const cstr_allocator_t *allocator, void *block, size_t alloc_size, size_t header_end, uint8_t type, size_t capacity)
+{
+	if (!_cstr_policy.harvest_slack || !allocator->usable_size)
+		return capacity;
+
+	size_t usable = allocator->usable_size(allocator->context, block, alloc_size);
+	if (usable <= alloc_size)
+		return capacity;
+
+	size_t harvested = usable - header_end - 1;
+	size_t type_max = _cstr_type_max(type);
+
+	return ((harvested > type_max) ? type_max : harvested);
+}
+
+#if	defined(CSTR_HAS_MMAP)
+
+size_t
+_cstr_page_size
+(void)
+{
+	static atomic_size_t cached = 0;
+
+	size_t page_size = atomic_load_explicit(&cached, memory_order_relaxed);
+	if (page_size == 0) {
+		page_size = (size_t)sysconf(_SC_PAGESIZE);
+		atomic_store_explicit(&cached, page_size, memory_order_relaxed);
+	}
+
+	return page_size;
+}
+
+size_t
+_cstr_mmap_length
+(size_t capacity)
+{
+	size_t page_size = _cstr_page_size();
+	size_t length = sizeof(cstr_shared_t) + sizeof(string_header64_t) + capacity + 1;
+
+	return (((length + page_size - 1) / page_size) * page_size);
+}
+
+void
+_cstr_mmap_advise
+(void *block, size_t length)
+{
+#if	defined(MADV_HUGEPAGE)
+	if (_cstr_policy.huge_pages)
+		madvise(block, length, MADV_HUGEPAGE);
+#else
+	(void)block;
+	(void)length;
+#endif
+}
+
+string_t
+_cstr_mmap_alloc
+(size_t capacity, uint8_t shared)
+{
+	size_t length = _cstr_mmap_length(capacity);
+	uint8_t flags = (uint8_t)(_cstr_type_for(length) | CSTR_FLAG_MMAP | shared);
+	size_t prefix_size = _cstr_prefix_size(flags);
+	size_t header_end = prefix_size + _cstr_header_size(flags);
+
+	char *block = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	assert((block != MAP_FAILED) && "failed to map string memory!");
+	_cstr_mmap_advise(block, length);
+
+	string_t string = _cstr_init_header(block + prefix_size, flags, 0, length - header_end - 1);
+	if (shared)
+		_cstr_init_shared(string);
+
+	return string;
+}
+
+string_t
+_cstr_mmap_from_heap
+(string_t string, size_t new_capacity)
+{
+	uint8_t flags = _cstr_flags(string);
+	size_t size = _cstr_get_size(string);
+
+	string_t new_string = _cstr_mmap_alloc(new_capacity, flags & CSTR_FLAG_SHARED);
+	memcpy(new_string, string, size + 1);
+	_cstr_set_size(new_string, size);
+
+	uint8_t new_flags = _cstr_flags(new_string);
+	((uint8_t *)new_string)[-1] = (uint8_t)(new_flags | (flags & ~CSTR_TYPE_MASK));
+
+	const cstr_allocator_t *allocator = _cstr_allocator_of(string);
+	allocator->free(allocator->context, _cstr_block(string), _cstr_block_size(string));
+
+	return new_string;
+}
+
+string_t
+_cstr_mmap_resize
+(string_t string, size_t new_capacity)
+{
+	uint8_t flags = _cstr_flags(string);
+	size_t size = _cstr_get_size(string);
+
+	size_t prefix_size = _cstr_prefix_size(flags);
+	size_t old_length = _cstr_block_size(string);
+	size_t old_header_end = prefix_size + _cstr_header_size(flags);
+
+	size_t new_length = _cstr_mmap_length(new_capacity);
+	uint8_t new_type = _cstr_type_for(new_length);
+	size_t new_header_end = prefix_size + _cstr_header_size(new_type);
+
+	char *block = _cstr_block(string);
+
+	if (new_header_end < old_header_end)
+		memmove(block + new_header_end, block + old_header_end, size + 1);
+
+	if (new_length != old_length) {
+		block = mremap(block, old_length, new_length, MREMAP_MAYMOVE);
+		assert((block != MAP_FAILED) && "failed to remap string memory!");
+		_cstr_mmap_advise(block, new_length);
+	}
+
+	if (new_header_end > old_header_end)
+		memmove(block + new_header_end, block + old_header_end, size + 1);
+
+	flags = (uint8_t)((flags & ~CSTR_TYPE_MASK) | new_type);
+	return _cstr_init_header(block + prefix_size, flags, size, new_length - new_header_end - 1);
+}
+
+#endif
+
+string_t
+_cstr_alloc_ext
+(size_t capacity, const cstr_allocator_t *allocator, uint8_t shared)
+{
+#if	defined(CSTR_HAS_MMAP)
+	if ((allocator == &_cstr_default_allocator) && _cstr_policy.mmap_threshold && (capacity >= _cstr_policy.mmap_threshold))
+		return _cstr_mmap_alloc(capacity, shared);
+#endif
+
+	uint8_t flags = (uint8_t)(_cstr_type_for(capacity) | shared);
+	if (allocator != &_cstr_default_allocator)
+		flags |= CSTR_FLAG_ALLOCATOR;
+
+	size_t prefix_size = _cstr_prefix_size(flags);
+	size_t header_end = prefix_size + _cstr_header_size(flags);
+	size_t alloc_size = header_end + capacity + 1;
+
+	char *block = allocator->alloc(allocator->context, alloc_size);
+	assert(block && "failed to allocate new string!");
+
+	if (flags & CSTR_FLAG_ALLOCATOR)
+		memcpy(block, &allocator, sizeof(allocator));
+
+	capacity = _cstr_harvest(allocator, block, alloc_size, header_end, flags, capacity);
+
+	string_t string = _cstr_init_header(block + prefix_size, flags, 0, capacity);
+	if (shared)
+		_cstr_init_shared(string);
+	string[0] = '\0';
+
+	return string;
+}
+
+string_t
+_cstr_alloc
+(size_t capacity, const cstr_allocator_t *allocator)
+{
+	return _cstr_alloc_ext(capacity, allocator, 0);
+}
+
+#if	defined(CSTR_HAS_MMAP)
+
+string_t
+_cstr_mmap_to_heap
+(string_t string, size_t new_capacity)
+{
+	uint8_t flags = _cstr_flags(string);
+	size_t size = _cstr_get_size(string);
+
+	string_t new_string = _cstr_alloc_ext(new_capacity, &_cstr_default_allocator, flags & CSTR_FLAG_SHARED);
+	memcpy(new_string, string, size + 1);
+	_cstr_set_size(new_string, size);
+
+	uint8_t new_flags = _cstr_flags(new_string);
+	((uint8_t *)new_string)[-1] = (uint8_t)(new_flags | (flags & ~(CSTR_TYPE_MASK | CSTR_FLAG_MMAP)));
+
+	munmap(_cstr_block(string), _cstr_block_size(string));
+	return new_string;
+}
+
+size_t
+_cstr_mmap_release
+(string_t string, size_t keep)
+{
+	size_t page_size = _cstr_page_size();
+	char *block = _cstr_block(string);
+	size_t length = _cstr_block_size(string);
+
+	size_t offset = (size_t)(string - block) + keep + 1;
+	offset = ((offset + page_size - 1) / page_size) * page_size;
+
+	if (offset < length)
+		madvise(block + offset, length - offset, MADV_DONTNEED);
+
+	return (offset - (size_t)(string - block));
+}
+
+#endif
+
+string_t
+_cstr_buffer_spill
+(string_t string, size_t new_capacity)
+{
+	uint8_t flags = _cstr_flags(string);
+	size_t size = _cstr_get_size(string);
+
+	string_t new_string = _cstr_alloc(new_capacity, _cstr_global_allocator);
+	memcpy(new_string, string, size + 1);
+	_cstr_set_size(new_string, size);
+
+	uint8_t new_flags = _cstr_flags(new_string);
+	((uint8_t *)new_string)[-1] = (uint8_t)(new_flags | (flags & ~(CSTR_TYPE_MASK | CSTR_FLAG_BUFFER)));
+
+	return new_string;
+}
+
+string_t
+_cstr_realloc
+(string_t string, size_t new_capacity)
+{
+	uint8_t flags = _cstr_flags(string);
+	size_t size = _cstr_get_size(string);
+	assert((size <= new_capacity) && "new capacity cannot hold string contents!");
+	assert(!(flags & CSTR_FLAG_STATIC) && "immutable strings cannot be reallocated!");
+
+	if (flags & CSTR_FLAG_BUFFER) {
+		if (new_capacity <= _cstr_get_capacity(string))
+			return string;
+
+		return _cstr_buffer_spill(string, new_capacity);
+	}
+
+#if	defined(CSTR_HAS_MMAP)
+	if (flags & CSTR_FLAG_MMAP) {
+		if (new_capacity >= (_cstr_policy.mmap_threshold / 2))
+			return _cstr_mmap_resize(string, new_capacity);
+
+		return _cstr_mmap_to_heap(string, new_capacity);
+	}
+
+	if (!(flags & CSTR_FLAG_ALLOCATOR) && _cstr_policy.mmap_threshold && (new_capacity >= _cstr_policy.mmap_threshold))
+		return _cstr_mmap_from_heap(string, new_capacity);
+#endif
+
+	const cstr_allocator_t *allocator = _cstr_allocator_of(string);
+
+	size_t prefix_size = _cstr_prefix_size(flags);
+	size_t old_header_end = prefix_size + _cstr_header_size(flags);
+	uint8_t new_type = _cstr_type_for(new_capacity);
+	size_t new_header_end = prefix_size + _cstr_header_size(new_type);
+
+	size_t old_alloc_size = _cstr_block_size(string);
+	size_t new_alloc_size = new_header_end + new_capacity + 1;
+
+	char *block = _cstr_block(string);
+
+	if (new_header_end > old_header_end) {
+		block = allocator->realloc(allocator->context, block, old_alloc_size, new_alloc_size);
+		assert(block && "failed to resize string and allocate memory!");
+		memmove(block + new_header_end, block + old_header_end, size + 1);
+	}
+	else {
+		if (new_header_end < old_header_end)
+			memmove(block + new_header_end, block + old_header_end, size + 1);
+		block = allocator->realloc(allocator->context, block, old_alloc_size, new_alloc_size);
+		assert(block && "failed to resize string and allocate memory!");
+	}
+
+	new_capacity = _cstr_harvest(allocator, block, new_alloc_size, new_header_end, new_type, new_capacity);
+
+	flags = (uint8_t)((flags & ~CSTR_TYPE_MASK) | new_type);
+	return _cstr_init_header(block + prefix_size, flags, size, new_capacity);
+}
+
+size_t
+_cstr_grow_capacity
+(size_t capacity, size_t size)
+{
+	size_t new_capacity = (capacity > 0) ? capacity : CSTR_DEFAULT_CAPACITY;
+
+	while (new_capacity < size) {
+		size_t grown = (size_t)((double)new_capacity * _cstr_policy.growth_factor);
+		new_capacity = (grown > new_capacity) ? grown : (new_capacity + 1);
+	}
+
+	size_t page_size = _cstr_policy.page_size;
+	if (_cstr_policy.page_threshold && page_size && (new_capacity >= _cstr_policy.page_threshold))
+		new_capacity = ((new_capacity + page_size - 1) / page_size) * page_size;
+
+	return new_capacity;
+}
+
+string_t
+_cstr_expand
+(string_t string, const size_t size)
+{
+	size_t capacity = _cstr_get_capacity(string);
+	if (size <= capacity)
+		return string;
+
+	return _cstr_realloc(string, _cstr_grow_capacity(capacity, size));
+}
+
+string_t
+_cstr_auto_shrink
+(string_t string)
+{
+	if (_cstr_policy.shrink_ratio <= 0.0)
+		return string;
+
+	size_t size = _cstr_get_size(string);
+	size_t capacity = _cstr_get_capacity(string);
+
+	if ((capacity <= CSTR_DEFAULT_CAPACITY) || ((double)size >= (double)capacity * _cstr_policy.shrink_ratio))
+		return string;
+
+	size_t target = (size_t)((double)size * _cstr_policy.growth_factor);
+	if (target < CSTR_DEFAULT_CAPACITY)
+		target = CSTR_DEFAULT_CAPACITY;
+
+	if (target >= capacity)
+		return string;
+
+	return _cstr_realloc(string, target);
+}
+
+string_t
+_cstr_mutable
+(string_t string)
+{
+	uint8_t flags = _cstr_flags(string);
+	if (!(flags & (CSTR_FLAG_STATIC | CSTR_FLAG_SHARED)))
+		return string;
+
+	if (!(flags & CSTR_FLAG_STATIC) && !_cstr_is_shared(string)) {
+		_cstr_invalidate_hash(string);
+		return string;
+	}
+
+	size_t size = _cstr_get_size(string);
+	size_t capacity = (flags & CSTR_FLAG_STATIC) ? size : _cstr_get_capacity(string);
+	const cstr_allocator_t *allocator = (flags & CSTR_FLAG_STATIC) ? _cstr_global_allocator : _cstr_allocator_of(string);
+
+	string_t copy = _cstr_alloc((capacity > CSTR_DEFAULT_CAPACITY) ? capacity : CSTR_DEFAULT_CAPACITY, allocator);
+	memcpy(copy, string, size);
+	_cstr_set_size(copy, size);
+
+	if (flags & CSTR_FLAG_SHARED)
+		cstr_release(string);
+
+	return copy;
+}
+
+bool
+_cstr_invalid
+(string_t string)
+{
+	return (_cstr_get_size(string) > _cstr_get_capacity(string));
+}
+
+
+void
+cstr_set_allocator
+(const cstr_allocator_t *allocator)
+{
+	_cstr_global_allocator = (allocator ? allocator : &_cstr_default_allocator);
+}
+
+const cstr_allocator_t *
+cstr_get_allocator
+(void)
+{
+	return _cstr_global_allocator;
+}
+
+const cstr_allocator_t *
+cstr_allocator
+(string_t string)
+{
+	return _cstr_allocator_of(string);
+}
+
+
+void
+cstr_set_policy
+(const cstr_policy_t *policy)
+{
+	assert(policy && "policy argument must be valid!");
+	assert((policy->growth_factor > 1.0) && "growth_factor must be greater than one!");
+	assert((policy->shrink_ratio < 1.0) && "shrink_ratio must be less than one!");
+
+	_cstr_policy = *policy;
+}
+
+cstr_policy_t
+cstr_get_policy
+(void)
+{
+	return _cstr_policy;
+}
+
+
+
+typedef struct cstr_arena_chunk_t
+{
+	struct cstr_arena_chunk_t *	_next;
+	size_t						_capacity;
+}
+cstr_arena_chunk_t;
+
+struct cstr_arena_t
+{
+	cstr_allocator_t			_allocator;
+	const cstr_allocator_t *	_parent;
+
+	cstr_arena_chunk_t *		_head;
+	cstr_arena_chunk_t *		_current;
+	size_t						_offset;
+	size_t						_chunk_size;
+};
+
+
+char *
+_cstr_arena_chunk_data
+(cstr_arena_chunk_t *chunk)
+{
+	return ((char *)chunk + CSTR_ARENA_ALIGN_UP(sizeof(cstr_arena_chunk_t)));
+}
+
+cstr_arena_chunk_t *
+_cstr_arena_chunk_new
+(cstr_arena_t *arena, size_t size)
+{
+	size_t capacity = (size > arena->_chunk_size) ? size : arena->_chunk_size;
+	size_t alloc_size = CSTR_ARENA_ALIGN_UP(sizeof(cstr_arena_chunk_t)) + capacity;
+
+	cstr_arena_chunk_t *chunk = arena->_parent->alloc(arena->_parent->context, alloc_size);
+	assert(chunk && "failed to allocate arena chunk!");
+
+	chunk->_next = NULL;
+	chunk->_capacity = capacity;
+
+	return chunk;
+}
+
+void *
+_cstr_arena_alloc
+(void *context, size_t size)
+{
+	cstr_arena_t *arena = context;
+	size_t aligned_size = CSTR_ARENA_ALIGN_UP(size);
+
+	if (arena->_current && (arena->_offset + aligned_size <= arena->_current->_capacity)) {
+		char *ptr = _cstr_arena_chunk_data(arena->_current) + arena->_offset;
+		arena->_offset += aligned_size;
+		return ptr;
+	}
+
+	cstr_arena_chunk_t *chunk = (arena->_current ? arena->_current->_next : arena->_head);
+	if (!chunk || (chunk->_capacity < aligned_size)) {
+		cstr_arena_chunk_t *new_chunk = _cstr_arena_chunk_new(arena, aligned_size);
+		new_chunk->_next = chunk;
+
+		if (arena->_current)
+			arena->_current->_next = new_chunk;
+		else
+			arena->_head = new_chunk;
+
+		chunk = new_chunk;
+	}
+
+	arena->_current = chunk;
+	arena->_offset = aligned_size;
+
+	return _cstr_arena_chunk_data(chunk);
+}
+
+bool
+_cstr_arena_is_last
+(cstr_arena_t *arena, void *ptr, size_t size)
+{
+	if (!arena->_current)
+		return false;
+
+	char *top = _cstr_arena_chunk_data(arena->_current) + arena->_offset;
+	return ((char *)ptr + CSTR_ARENA_ALIGN_UP(size) == top);
+}
+
+void *
+_cstr_arena_realloc
+(void *context, void *ptr, size_t old_size, size_t new_size)
+{
+	cstr_arena_t *arena = context;
+
+	if (_cstr_arena_is_last(arena, ptr, old_size)) {
+		size_t start = (size_t)((char *)ptr - _cstr_arena_chunk_data(arena->_current));
+		size_t end = start + CSTR_ARENA_ALIGN_UP(new_size);
+
+		if (end <= arena->_current->_capacity) {
+			arena->_offset = end;
+			return ptr;
+		}
+	}
+
+	void *new_ptr = _cstr_arena_alloc(arena, new_size);
+	memcpy(new_ptr, ptr, (old_size < new_size) ? old_size : new_size);
+
+	return new_ptr;
+}
+
+void
+_cstr_arena_free
+(void *context, void *ptr, size_t size)
+{
+	cstr_arena_t *arena = context;
+
+	if (_cstr_arena_is_last(arena, ptr, size))
+		arena->_offset -= CSTR_ARENA_ALIGN_UP(size);
+}
+
+size_t
+_cstr_arena_usable_size
+(void *context, void *ptr, size_t size)
+{
+	(void)context;
+	(void)ptr;
+	return CSTR_ARENA_ALIGN_UP(size);
+}
+
+
+cstr_arena_t *
+cstr_arena_new
+(size_t chunk_size)
+{
+	const cstr_allocator_t *parent = _cstr_global_allocator;
+
+	cstr_arena_t *arena = parent->alloc(parent->context, sizeof(cstr_arena_t));
+	assert(arena && "failed to allocate arena!");
+
+	arena->_allocator.alloc = _cstr_arena_alloc;
+	arena->_allocator.realloc = _cstr_arena_realloc;
+	arena->_allocator.free = _cstr_arena_free;
+	arena->_allocator.context = arena;
+	arena->_allocator.usable_size = _cstr_arena_usable_size;
+
+	arena->_parent = parent;
+	arena->_head = NULL;
+	arena->_current = NULL;
+	arena->_offset = 0;
+	arena->_chunk_size = (chunk_size > 0) ? chunk_size : CSTR_ARENA_DEFAULT_CHUNK;
+
+	return arena;
+}
+
+void
+cstr_arena_destroy
+(cstr_arena_t *arena)
+{
+	assert(arena && "arena argument must be valid!");
+
+	const cstr_allocator_t *parent = arena->_parent;
+
+	cstr_arena_chunk_t *chunk = arena->_head;
+	while (chunk) {
+		cstr_arena_chunk_t *next = chunk->_next;
+		parent->free(parent->context, chunk, CSTR_ARENA_ALIGN_UP(sizeof(cstr_arena_chunk_t)) + chunk->_capacity);
+		chunk = next;
+	}
+
+	parent->free(parent->context, arena, sizeof(cstr_arena_t));
+}
+
+void
+cstr_arena_reset
+(cstr_arena_t *arena)
+{
+	assert(arena && "arena argument must be valid!");
+
+	arena->_current = arena->_head;
+	arena->_offset = 0;
+}
+
+cstr_arena_mark_t
+cstr_arena_mark
+(cstr_arena_t *arena)
+{
+	assert(arena && "arena argument must be valid!");
+
+	cstr_arena_mark_t mark;
+	mark._chunk = arena->_current;
+	mark._offset = arena->_offset;
+
+	return mark;
+}
+
+void
+cstr_arena_rollback
+(cstr_arena_t *arena, cstr_arena_mark_t mark)
+{
+	assert(arena && "arena argument must be valid!");
+
+	if (!mark._chunk) {
+		cstr_arena_reset(arena);
+		return;
+	}
+
+	arena->_current = mark._chunk;
+	arena->_offset = mark._offset;
+}
+
+const cstr_allocator_t *
+cstr_arena_allocator
+(cstr_arena_t *arena)
+{
+	assert(arena && "arena argument must be valid!");
+
+	return &arena->_allocator;
+}
+
+string_t
+cstr_arena_string
+(cstr_arena_t *arena, const char *string)
+{
+	return cstr_new_with(string, cstr_arena_allocator(arena));
+}
+
+string_t
+cstr_new
+(const char *string)
+{
+	return cstr_new_with(string, _cstr_global_allocator);
+}
+
+string_t
+cstr_new_with
+(const char *string, const cstr_allocator_t *allocator)
+{
+	assert(string && "string argument must be valid!");
+	assert(allocator && "allocator argument must be valid!");
+
+	size_t length = strlen(string);
+
+	size_t capacity = CSTR_DEFAULT_CAPACITY;
+	while (capacity < length)
+		capacity <<= 1;
+
+	string_t new_string = _cstr_alloc(capacity, allocator);
+	memcpy(new_string, string, length);
+	_cstr_set_size(new_string, length);
+
+	return new_string;
+}
+
+string_t
+cstr_reserve
+(const size_t capacity)
+{
+	return cstr_reserve_with(capacity, _cstr_global_allocator);
+}
+
+string_t
+cstr_reserve_with
+(const size_t capacity, const cstr_allocator_t *allocator)
+{
+	assert((capacity > 0) && "capacity must be greater than zero!");
+	assert(allocator && "allocator argument must be valid!");
+
+	return _cstr_alloc(capacity, allocator);
+}
+
+string_t
+cstr_reserve_string
+(string_t string, size_t capacity)
+{
+	if (capacity <= _cstr_get_capacity(string))
+		return string;
+
+	string = _cstr_mutable(string);
+	return _cstr_expand(string, capacity);
+}
+
+string_t
+cstr_init_buffer
+(void *buffer, size_t buffer_size)
+{
+	assert(buffer && "buffer argument must be valid!");
+	assert((buffer_size > sizeof(string_header8_t) + 1) && "buffer is too small to hold a string!");
+
+	uint8_t type = _cstr_type_for(buffer_size);
+	size_t capacity = buffer_size - _cstr_header_size(type) - 1;
+
+	string_t string = _cstr_init_header(buffer, (uint8_t)(type | CSTR_FLAG_BUFFER), 0, capacity);
+	string[0] = '\0';
+
+	return string;
+}
+
+bool
+cstr_is_buffered
+(string_t string)
+{
+	return ((_cstr_flags(string) & CSTR_FLAG_BUFFER) != 0);
+}
+
+bool
+cstr_is_immutable
+(string_t string)
+{
+	return ((_cstr_flags(string) & CSTR_FLAG_STATIC) != 0);
+}
+
+void
+cstr_destroy
+(string_t string)
+{
+	assert(_cstr_header(string) && "failed to locate header address!");
+
+	if ((_cstr_flags(string) & CSTR_FLAG_BUFFER) || ((_cstr_flags(string) & (CSTR_FLAG_STATIC | CSTR_FLAG_SHARED)) == CSTR_FLAG_STATIC))
+		return;
+
+	if ((_cstr_flags(string) & CSTR_FLAG_SHARED) && (atomic_fetch_sub_explicit(_cstr_refcount(string), 1u, memory_order_acq_rel) != 1))
+		return;
+
+#if	defined(CSTR_HAS_MMAP)
+	if (_cstr_flags(string) & CSTR_FLAG_MMAP) {
+		munmap(_cstr_block(string), _cstr_block_size(string));
+		return;
+	}
+#endif
+
+	const cstr_allocator_t *allocator = _cstr_allocator_of(string);
+	allocator->free(allocator->context, _cstr_block(string), _cstr_block_size(string));
+}
+
+string_t
+cstr_retain
+(string_t string)
+{
+	uint8_t flags = _cstr_flags(string);
+
+	if ((flags & (CSTR_FLAG_STATIC | CSTR_FLAG_SHARED)) == CSTR_FLAG_STATIC)
+		return string;
+
+	if (!(flags & CSTR_FLAG_SHARED) || (atomic_load_explicit(_cstr_refcount(string), memory_order_relaxed) == UINT_MAX))
+		return cstr_new_view(cstr_view(string, 0, CSTR_NPOS));
+
+	atomic_fetch_add_explicit(_cstr_refcount(string), 1u, memory_order_relaxed);
+	return string;
+}
+
+void
+cstr_release
+(string_t string)
+{
+	cstr_destroy(string);
+}
+
+string_t
+_cstr_shared_copy
+(string_t string, size_t capacity, const cstr_allocator_t *allocator)
+{
+	size_t size = _cstr_get_size(string);
+
+	string_t shared = _cstr_alloc_ext((capacity > CSTR_DEFAULT_CAPACITY) ? capacity : CSTR_DEFAULT_CAPACITY, allocator, CSTR_FLAG_SHARED);
+	memcpy(shared, string, size);
+	_cstr_set_size(shared, size);
+
+	return shared;
+}
+
+string_t
+cstr_share
+(string_t string)
+{
+	uint8_t flags = _cstr_flags(string);
+	if (flags & CSTR_FLAG_SHARED)
+		return string;
+
+	bool owned = !(flags & (CSTR_FLAG_STATIC | CSTR_FLAG_BUFFER));
+	size_t capacity = owned ? _cstr_get_capacity(string) : _cstr_get_size(string);
+	const cstr_allocator_t *allocator = owned ? _cstr_allocator_of(string) : _cstr_global_allocator;
+
+	string_t shared = _cstr_shared_copy(string, capacity, allocator);
+
+	if (owned)
+		cstr_destroy(string);
+
+	return shared;
+}
+
+bool
+cstr_is_shared
+(string_t string)
+{
+	return _cstr_is_shared(string);
+}
+
+
+void
+_cstr_clear
+(string_t string)
+{
+#if	defined(CSTR_HAS_MMAP)
+	if (_cstr_flags(string) & CSTR_FLAG_MMAP) {
+		size_t size = _cstr_get_size(string);
+		size_t resident = _cstr_mmap_release(string, 0);
+
+		memset(string, 0, (size < resident) ? size : resident);
+		_cstr_set_size(string, 0);
+		return;
+	}
+#endif
+
+	memset(string, 0, _cstr_get_size(string));
+	_cstr_set_size(string, 0);
+}
+
+string_t
+cstr_clear
+(string_t string)
+{
+	string = _cstr_mutable(string);
+	_cstr_clear(string);
+	return _cstr_auto_shrink(string);
+}
+
+string_t
+cstr_shrink_to_fit
+(string_t string)
+{
+	if ((_cstr_flags(string) & CSTR_FLAG_STATIC) || _cstr_is_shared(string))
+		return string;
+
+	return _cstr_realloc(string, _cstr_get_size(string));
+}
+
+string_t
+cstr_resize
+(string_t string, size_t n, char c)
+{
+	string = _cstr_mutable(string);
+
+	size_t old_size = _cstr_get_size(string);
+
+	if (n > _cstr_get_capacity(string))
+		string = _cstr_expand(string, n);
+
+	for (size_t i = old_size; i < n; ++i)
+		string[i] = c;
+
+	_cstr_set_size(string, n);
+	return _cstr_auto_shrink(string);
+}
+
+string_t
+cstr_append
+(string_t string, const char *append_str)
+{
+	assert(append_str && "append_str argument must be valid!");
+
+	string = _cstr_mutable(string);
+
+	size_t old_size = _cstr_get_size(string);
+	size_t append_length = strlen(append_str);
+	size_t new_size = old_size + append_length;
+
+	if (new_size > _cstr_get_capacity(string))
+		string = _cstr_expand(string, new_size);
+
+	memcpy(string + old_size, append_str, append_length);
+
+	_cstr_set_size(string, new_size);
+	return string;
+}
+
+string_t
+cstr_append_n
+(string_t string, const char *append_str, size_t n)
+{
+	assert(append_str && "append_str argument must be valid!");
+	assert((n <= strlen(append_str)) && "n should be less than or equal to length of append_str!");
+
+	string = _cstr_mutable(string);
+
+	size_t old_size = _cstr_get_size(string);
+	size_t new_size = old_size + n;
+
+	if (new_size > _cstr_get_capacity(string))
+		string = _cstr_expand(string, new_size);
+
+	memcpy(string + old_size, append_str, n);
+
+	_cstr_set_size(string, new_size);
+	return string;
+}
+
+string_t
+cstr_append_string
+(string_t string, const string_t append_str)
+{
+	assert(append_str && "append_str argument must be valid!");
+
+	return cstr_append(string, cstr_data(append_str));
+}
+
+string_t
+cstr_append_substring
+(string_t string, const string_t append_str, size_t subpos, size_t sublen)
+{
+	assert(append_str && "append_str argument must be valid!");
+
+	size_t length = cstr_length(append_str);
+	if (subpos < length) {
+		size_t actual_sublen = ((sublen > (length - subpos)) ? (length - subpos) : sublen);
+		return cstr_append_n(string, cstr_data(append_str) + subpos, actual_sublen);
+	}
+
+	return string;
+}
+
+string_t
+cstr_append_fill
+(string_t string, size_t n, char c)
+{
+	string = _cstr_mutable(string);
+
+	size_t old_size = _cstr_get_size(string);
+	size_t new_size = old_size + n;
+
+	if (new_size > _cstr_get_capacity(string))
+		string = _cstr_expand(string, new_size);
+
+	memset(string + old_size, c, n);
+
+	_cstr_set_size(string, new_size);
+	return string;
+}
+
+string_t
+cstr_append_range
+(string_t string, const void *start, const void *end)
+{
+	string = _cstr_mutable(string);
+
+	size_t old_size = _cstr_get_size(string);
+	size_t append_length = (ptrdiff_t)((char *)end - (char *)start);
+	size_t new_size = old_size + append_length;
+
+	if (new_size > _cstr_get_capacity(string))
+		string = _cstr_expand(string, new_size);
+
+	memcpy(string + old_size, start, append_length);
+
+	_cstr_set_size(string, new_size);
+	return string;
+}
+
+bool
+_cstr_points_into
+(string_t string, const void *ptr)
+{
+	uintptr_t address = (uintptr_t)ptr;
+	uintptr_t low = (uintptr_t)string;
+	uintptr_t high = (uintptr_t)(string + _cstr_get_capacity(string) + 1);
+
+	return ((address >= low) && (address < high));
+}
+
+bool
+_cstr_format_aliases
+(string_t string, const char *format, va_list args)
+{
+	if (_cstr_points_into(string, format))
+		return true;
+
+	for (const char *p = format; *p; ++p) {
+		if (*p != '%')
+			continue;
+
+		if (*++p == '%')
+			continue;
+
+		while (*p && strchr("-+ #0'", *p))
+			++p;
+
+		if (*p == '*') {
+			(void)va_arg(args, int);
+			++p;
+		}
+		else {
+			while ((*p >= '0') && (*p <= '9'))
+				++p;
+		}
+
+		if (*p == '$')
+			return true;
+
+		if (*p == '.') {
+			if (*++p == '*') {
+				(void)va_arg(args, int);
+				++p;
+			}
+			else {
+				while ((*p >= '0') && (*p <= '9'))
+					++p;
+			}
+		}
+
+		char length = 0;
+		if ((p[0] == 'h') && (p[1] == 'h')) {
+			p += 2;
+		}
+		else if ((p[0] == 'l') && (p[1] == 'l')) {
+			length = 'q';
+			p += 2;
+		}
+		else if (*p && strchr("hljztLq", *p)) {
+			length = *p++;
+		}
+
+		switch (*p) {
+		case 'c': case 'C':
+			(void)va_arg(args, int);
+			break;
+
+		case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+			switch (length) {
+			case 'q':
+			case 'L':	(void)va_arg(args, long long);	break;
+			case 'l':	(void)va_arg(args, long);		break;
+			case 'j':	(void)va_arg(args, intmax_t);	break;
+			case 'z':	(void)va_arg(args, size_t);		break;
+			case 't':	(void)va_arg(args, ptrdiff_t);	break;
+			default:	(void)va_arg(args, int);		break;
+			}
+			break;
+
+		case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+			if (length == 'L')
+				(void)va_arg(args, long double);
+			else
+				(void)va_arg(args, double);
+			break;
+
+		case 's': case 'S': case 'p': case 'n':
+			if (_cstr_points_into(string, va_arg(args, const void *)))
+				return true;
+			break;
+
+		case 'm':
+			break;
+
+		default:
+			return true;
+		}
+	}
+
+	return false;
+}
+
+string_t
+_cstr_append_vfmt_copy
+(string_t string, const char *format, va_list args)
+{
+	size_t old_size = _cstr_get_size(string);
+
+	va_list retry;
+	va_copy(retry, args);
+
+	int length = vsnprintf(NULL, 0, format, args);
+	if (length < 0) {
+		va_end(retry);
+		return string;
+	}
+
+	char *formatted = _cstr_temp_alloc((size_t)length + 1);
+	vsnprintf(formatted, (size_t)length + 1, format, retry);
+	va_end(retry);
+
+	size_t new_size = old_size + (size_t)length;
+	if (new_size > _cstr_get_capacity(string))
+		string = _cstr_expand(string, new_size);
+
+	memcpy(string + old_size, formatted, (size_t)length);
+	_cstr_temp_free(formatted, (size_t)length + 1);
+
+	_cstr_set_size(string, new_size);
+	return string;
+}
+
+string_t
+cstr_append_vfmt
+(string_t string, const char *format, va_list args)
+{
+	assert(format && "format argument must be valid!");
+
+	string = _cstr_mutable(string);
+
+	va_list probe;
+	va_copy(probe, args);
+	bool aliases = _cstr_format_aliases(string, format, probe);
+	va_end(probe);
+
+	if (aliases)
+		return _cstr_append_vfmt_copy(string, format, args);
+
+	size_t old_size = _cstr_get_size(string);
+	size_t spare = _cstr_get_capacity(string) - old_size;
+
+	va_list retry;
+	va_copy(retry, args);
+
+	int length = vsnprintf(string + old_size, spare + 1, format, args);
+	if (length < 0) {
+		va_end(retry);
+		string[old_size] = '\0';
+		return string;
+	}
+
+	size_t new_size = old_size + (size_t)length;
+
+	if ((size_t)length > spare) {
+		string = _cstr_expand(string, new_size);
+		vsnprintf(string + old_size, (size_t)length + 1, format, retry);
+	}
+
+	va_end(retry);
+
+	_cstr_set_size(string, new_size);
+	return string;
+}
+
+string_t
+cstr_append_fmt
+(string_t string, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+
+	string = cstr_append_vfmt(string, format, args);
+
+	va_end(args);
+	return string;
+}
+
+string_t
+cstr_push_back
+(string_t string, char c)
+{
+	string = _cstr_mutable(string);
+
+	size_t size = _cstr_get_size(string);
+
+	if (size + 1 > _cstr_get_capacity(string))
+		string = _cstr_expand(string, size + 1);
+
+	string[size] = c;
+	_cstr_set_size(string, size + 1);
+	return string;
+}
+
+string_t
+cstr_pop_back
+(string_t string)
+{
+	string = _cstr_mutable(string);
+
+	_cstr_set_size(string, _cstr_get_size(string) - 1);
+	return _cstr_auto_shrink(string);
+}
+
+string_t
+cstr_assign
+(string_t string, const char *assign_str)
+{
+	assert(assign_str && "assign_str argument must be valid!");
+
+	string = _cstr_mutable(string);
+	_cstr_clear(string);
+	return cstr_append(string, assign_str);
+}
+
+string_t
+cstr_assign_n
+(string_t string, const char *assign_str, size_t n)
+{
+	assert(assign_str && "assign_str argument must be valid!");
+
+	string = _cstr_mutable(string);
+	_cstr_clear(string);
+	return cstr_append_n(string, assign_str, n);
+}
+
+string_t
+cstr_assign_string
+(string_t string, const string_t assign_str)
+{
+	assert(assign_str && "assign_str argument must be valid!");
+
+	string = _cstr_mutable(string);
+	_cstr_clear(string);
+	return cstr_append_string(string, assign_str);
+}
+
+string_t
+cstr_assign_substring
+(string_t string, const string_t assign_str, size_t subpos, size_t sublen)
+{
+	assert(assign_str && "assign_str argument must be valid!");
+
+	string = _cstr_mutable(string);
+	_cstr_clear(string);
+	return cstr_append_substring(string, assign_str, subpos, sublen);
+}
+
+string_t
+cstr_assign_fill
+(string_t string, size_t n, char c)
+{
+	string = _cstr_mutable(string);
+	_cstr_clear(string);
+	return cstr_append_fill(string, n, c);
+}
+
+string_t
+cstr_assign_range
+(string_t string, const void *start, const void *end)
+{
+	string = _cstr_mutable(string);
+	_cstr_clear(string);
+	return cstr_append_range(string, start, end);
+}
+
+string_t
+cstr_insert
+(string_t string, size_t pos, const char *insert_str)
+{
+	assert(insert_str && "insert_str argument must be valid!");
+
+	return cstr_insert_n(string, pos, insert_str, strlen(insert_str));
+}
+
+string_t
+cstr_insert_n
+(string_t string, size_t pos, const char *insert_str, size_t n)
+{
+	assert(insert_str && "insert_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "pos argument is out of range!");
+
+	string = _cstr_mutable(string);
+
+	size_t old_size = _cstr_get_size(string);
+	size_t new_size = old_size + n;
+
+	if (new_size > _cstr_get_capacity(string))
+		string = _cstr_expand(string, new_size);
+
+	size_t move_size = old_size - pos;
+	memmove(string + (pos + n), string + pos, move_size);
+
+	memcpy(string + pos, insert_str, n);
+
+	_cstr_set_size(string, new_size);
+	return string;
+}
+
+string_t
+cstr_insert_string
+(string_t string, size_t pos, const string_t insert_str)
+{
+	assert(insert_str && "insert_str argument must be valid!");
+
+	return cstr_insert(string, pos, cstr_data(insert_str));
+}
+
+string_t
+cstr_insert_substring
+(string_t string, size_t pos, const string_t insert_str, size_t subpos, size_t sublen)
+{
+	assert(insert_str && "insert_str argument must be valid!");
+
+	size_t length = cstr_length(insert_str);
+	if (subpos < length) {
+		size_t actual_sublen = ((sublen > (length - subpos)) ? (length - subpos) : sublen);
+		return cstr_insert_n(string, pos, cstr_data(insert_str) + subpos, actual_sublen);
+	}
+
+	return string;
+}
+
+string_t
+cstr_insert_fill
+(string_t string, size_t pos, size_t n, char c)
+{
+	assert((pos <= cstr_size(string)) && "pos argument is out of range!");
+
+	string = _cstr_mutable(string);
+
+	size_t old_size = _cstr_get_size(string);
+	size_t new_size = old_size + n;
+
+	if (new_size > _cstr_get_capacity(string))
+		string = _cstr_expand(string, new_size);
+
+	size_t move_size = old_size - pos;
+	memmove(string + (pos + n), string + pos, move_size);
+
+	memset(string + pos, c, n);
+
+	_cstr_set_size(string, new_size);
+	return string;
+}
+
+string_t
+cstr_insert_range
+(string_t string, size_t pos, const void *start, const void *end)
+{
+	size_t insert_length = (ptrdiff_t)((char *)end - (char *)start);
+
+	return cstr_insert_n(string, pos, start, insert_length);
+}
+
+string_t
+cstr_erase
+(string_t string, size_t pos, size_t len)
+{
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+	assert((len <= (cstr_size(string) - pos)) && "'len' argument exceeds limit!");
+
+	string = _cstr_mutable(string);
+
+	size_t old_size = _cstr_get_size(string);
+	size_t new_size = old_size - len;
+
+	size_t move_size = old_size - (pos + len);
+	memmove(string + pos, string + (pos + len), move_size);
+
+	_cstr_set_size(string, new_size);
+	return _cstr_auto_shrink(string);
+}
+
+string_t
+cstr_erase_range
+(string_t string, const void *start, const void *end)
+{
+	size_t pos = (ptrdiff_t)((char *)start - string);
+	size_t erase_length = (ptrdiff_t)((char *)end - (char *)start);
+
+	return cstr_erase(string, pos, erase_length);
+}
+
+string_t
+cstr_replace
+(string_t string, size_t pos, size_t len, const char *replace_str)
+{
+	assert(replace_str && "replace_str argument must be valid!");
+
+	return cstr_replace_n(string, pos, len, replace_str, strlen(replace_str));
+}
+
+string_t
+cstr_replace_n
+(string_t string, size_t pos, size_t len, const char *replace_str, size_t n)
+{
+	assert(replace_str && "replace_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "pos argument is out of range!");
+	assert((len <= (cstr_size(string) - pos)) && "'len' argument exceed limit!");
+
+	string = _cstr_mutable(string);
+
+	size_t old_size = _cstr_get_size(string);
+	size_t new_size = old_size - len + n;
+
+	if (new_size > _cstr_get_capacity(string))
+		string = _cstr_expand(string, new_size);
+
+	size_t move_size = old_size - (pos + len);
+	memmove(string + (pos + n), string + (pos + len), move_size);
+
+	memcpy(string + pos, replace_str, n);
+
+	_cstr_set_size(string, new_size);
+	return ((new_size < old_size) ? _cstr_auto_shrink(string) : string);
+}
+
+string_t
+cstr_replace_string
+(string_t string, size_t pos, size_t len, const string_t replace_str)
+{
+	assert(replace_str && "replace_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "pos argument is out of range!");
+	assert((len <= (cstr_size(string) - pos)) && "'len' argument exceed limit!");
+
+	return cstr_replace(string, pos, len, cstr_data(replace_str));
+}
+
+string_t
+cstr_replace_substring
+(string_t string, size_t pos, size_t len, const string_t replace_str, size_t subpos, size_t sublen)
+{
+	assert(replace_str && "replace_str argument must be valid!");
+
+	size_t length = cstr_length(replace_str);
+	if (subpos < length) {
+		size_t actual_sublen = ((sublen > (length - subpos)) ? (length - subpos) : sublen);
+		return cstr_replace_n(string, pos, len, cstr_data(replace_str) + subpos, actual_sublen);
+	}
+
+	return string;
+}
+
+string_t
+cstr_replace_fill
+(string_t string, size_t pos, size_t len, size_t n, char c)
+{
+	assert((pos <= cstr_size(string)) && "pos argument is out of range!");
+	assert((len <= (cstr_size(string) - pos)) && "'len' argument exceed limit!");
+
+	string = _cstr_mutable(string);
+
+	size_t old_size = _cstr_get_size(string);
+	size_t new_size = old_size - len + n;
+
+	if (new_size > _cstr_get_capacity(string))
+		string = _cstr_expand(string, new_size);
+
+	size_t move_size = old_size - (pos + len);
+	memmove(string + (pos + n), string + (pos + len), move_size);
+
+	memset(string + pos, c, n);
+
+	_cstr_set_size(string, new_size);
+	return ((new_size < old_size) ? _cstr_auto_shrink(string) : string);
+}
+
+string_t
+cstr_replace_range
+(string_t string, size_t pos, size_t len, const void *start, const void *end)
+{
+	size_t replace_length = (ptrdiff_t)((char *)end - (char *)start);
+
+	return cstr_replace_n(string, pos, len, start, replace_length);
+}
+
+bool
+_cstr_edit_before
+(const cstr_edit_t *left, const cstr_edit_t *right)
+{
+	if (left->pos != right->pos)
+		return (left->pos < right->pos);
+
+	return ((left->len == 0) && (right->len != 0));
+}
+
+void
+_cstr_edit_insertion_sort
+(cstr_edit_t *edits, size_t count)
+{
+	for (size_t i = 1; i < count; ++i) {
+		if (!_cstr_edit_before(&edits[i], &edits[i - 1]))
+			continue;
+
+		cstr_edit_t edit = edits[i];
+		size_t j = i;
+
+		while ((j > 0) && _cstr_edit_before(&edit, &edits[j - 1])) {
+			edits[j] = edits[j - 1];
+			--j;
+		}
+
+		edits[j] = edit;
+	}
+}
+
+void
+_cstr_edit_merge
+(cstr_edit_t *edits, cstr_edit_t *buffer, size_t left, size_t middle, size_t right)
+{
+	memcpy(buffer + left, edits + left, (right - left) * sizeof(cstr_edit_t));
+
+	size_t i = left, j = middle, k = left;
+
+	while ((i < middle) && (j < right))
+		edits[k++] = _cstr_edit_before(&buffer[j], &buffer[i]) ? buffer[j++] : buffer[i++];
+
+	while (i < middle)
+		edits[k++] = buffer[i++];
+
+	while (j < right)
+		edits[k++] = buffer[j++];
+}
+
+void
+_cstr_edit_sort
+(cstr_edit_t *edits, size_t count)
+{
+	for (size_t start = 0; start < count; start += CSTR_EDIT_SORT_RUN)
+		_cstr_edit_insertion_sort(edits + start, ((count - start) < CSTR_EDIT_SORT_RUN) ? (count - start) : CSTR_EDIT_SORT_RUN);
+
+	cstr_edit_t *buffer = NULL;
+
+	for (size_t width = CSTR_EDIT_SORT_RUN; width < count; width *= 2) {
+		for (size_t left = 0; left + width < count; left += 2 * width) {
+			size_t middle = left + width;
+			size_t right = ((count - middle) < width) ? count : (middle + width);
+
+			if (!_cstr_edit_before(&edits[middle], &edits[middle - 1]))
+				continue;
+
+			if (!buffer)
+				buffer = _cstr_temp_alloc(count * sizeof(cstr_edit_t));
+
+			_cstr_edit_merge(edits, buffer, left, middle, right);
+		}
+	}
+
+	if (buffer)
+		_cstr_temp_free(buffer, count * sizeof(cstr_edit_t));
+}
+
+string_t
+cstr_edit_batch
+(string_t string, cstr_edit_t *edits, size_t count)
+{
+	assert((edits || (count == 0)) && "edits argument must be valid!");
+
+	if (count == 0)
+		return string;
+
+	_cstr_edit_sort(edits, count);
+
+	size_t old_size = _cstr_get_size(string);
+	size_t new_size = old_size;
+	size_t shift = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		assert((edits[i].pos <= old_size) && "edit 'pos' is out of range!");
+		assert((edits[i].len <= (old_size - edits[i].pos)) && "edit 'len' exceed limit!");
+		assert(((i == 0) || (edits[i].pos >= edits[i - 1].pos + edits[i - 1].len)) && "edits must not overlap!");
+		assert((edits[i].replace_str || (edits[i].replace_len == 0)) && "edit replace_str must be valid!");
+
+		new_size = new_size - edits[i].len + edits[i].replace_len;
+
+		if ((new_size > old_size) && (new_size - old_size > shift))
+			shift = new_size - old_size;
+	}
+
+	char *snapshot = NULL;
+
+	for (size_t i = 0; i < count; ++i) {
+		if ((edits[i].replace_len > 0) && _cstr_points_into(string, edits[i].replace_str)) {
+			snapshot = _cstr_temp_alloc(old_size + 1);
+			memcpy(snapshot, string, old_size);
+			break;
+		}
+	}
+
+	uintptr_t original = (uintptr_t)string;
+	string = _cstr_mutable(string);
+
+	if (old_size + shift > _cstr_get_capacity(string))
+		string = _cstr_expand(string, old_size + shift);
+
+	if (shift > 0)
+		memmove(string + shift, string, old_size);
+
+	const char *source = string + shift;
+	size_t read = 0, write = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		size_t keep = edits[i].pos - read;
+
+		memmove(string + write, source + read, keep);
+		write += keep;
+
+		const char *replace_str = edits[i].replace_str;
+		if (snapshot && ((uintptr_t)replace_str >= original) && ((uintptr_t)replace_str < original + old_size))
+			replace_str = snapshot + ((uintptr_t)replace_str - original);
+
+		memcpy(string + write, replace_str, edits[i].replace_len);
+		write += edits[i].replace_len;
+
+		read = edits[i].pos + edits[i].len;
+	}
+
+	memmove(string + write, source + read, old_size - read);
+
+	if (snapshot)
+		_cstr_temp_free(snapshot, old_size + 1);
+
+	_cstr_set_size(string, new_size);
+	return ((new_size < old_size) ? _cstr_auto_shrink(string) : string);
+}
+
+void
+cstr_swap
+(string_t *left, string_t *right)
+{
+	if (_cstr_invalid(*left))
+		*left = cstr_new(*left);
+
+	if (_cstr_invalid(*right))
+		*right = cstr_new(*right);
+
+	string_t temp = *left;
+	*left = *right;
+	*right = temp;
+}
+
+size_t
+cstr_copy
+(string_t string, char *s, size_t len, size_t pos)
+{
+	assert((pos <= cstr_size(string)) && "pos argument is out of range!");
+	assert((len <= (cstr_size(string) - pos)) && "'len' argument exceed limit!");
+
+	memcpy(s, string + pos, len);
+	s[len] = '\0';
+
+	return strlen(s);
+}
+
+typedef struct cstr_two_way_t
+{
+	size_t	_suffix;
+	size_t	_period;
+	bool	_periodic;
+}
+cstr_two_way_t;
+
+
+unsigned char
+_cstr_needle_at
+(const unsigned char *needle, size_t needle_len, size_t i, bool reverse)
+{
+	return (reverse ? needle[needle_len - 1 - i] : needle[i]);
+}
+
+size_t
+_cstr_critical_factorization
+(const unsigned char *needle, size_t needle_len, size_t *period, bool reverse)
+{
+	size_t max_suffix = SIZE_MAX;
+	size_t j = 0, k = 1, p = 1;
+
+	while (j + k < needle_len) {
+		unsigned char a = _cstr_needle_at(needle, needle_len, j + k, reverse);
+		unsigned char b = _cstr_needle_at(needle, needle_len, max_suffix + k, reverse);
+
+		if (a < b) {
+			j += k;
+			k = 1;
+			p = j - max_suffix;
+		}
+		else if (a == b) {
+			if (k != p) {
+				++k;
+			}
+			else {
+				j += p;
+				k = 1;
+			}
+		}
+		else {
+			max_suffix = j++;
+			k = p = 1;
+		}
+	}
+	*period = p;
+
+	size_t max_suffix_rev = SIZE_MAX;
+	j = 0;
+	k = p = 1;
+
+	while (j + k < needle_len) {
+		unsigned char a = _cstr_needle_at(needle, needle_len, j + k, reverse);
+		unsigned char b = _cstr_needle_at(needle, needle_len, max_suffix_rev + k, reverse);
+
+		if (b < a) {
+			j += k;
+			k = 1;
+			p = j - max_suffix_rev;
+		}
+		else if (a == b) {
+			if (k != p) {
+				++k;
+			}
+			else {
+				j += p;
+				k = 1;
+			}
+		}
+		else {
+			max_suffix_rev = j++;
+			k = p = 1;
+		}
+	}
+
+	if (max_suffix_rev + 1 < max_suffix + 1)
+		return (max_suffix + 1);
+
+	*period = p;
+	return (max_suffix_rev + 1);
+}
+
+cstr_two_way_t
+_cstr_two_way_prepare
+(const unsigned char *needle, size_t needle_len, bool reverse)
+{
+	cstr_two_way_t two_way;
+	two_way._suffix = _cstr_critical_factorization(needle, needle_len, &two_way._period, reverse);
+
+	if (reverse) {
+		size_t tail = needle_len - two_way._suffix;
+		two_way._periodic = (memcmp(needle + tail, needle + tail - two_way._period, two_way._suffix) == 0);
+	}
+	else {
+		two_way._periodic = (memcmp(needle, needle + two_way._period, two_way._suffix) == 0);
+	}
+
+	if (!two_way._periodic) {
+		size_t right = needle_len - two_way._suffix;
+		two_way._period = ((two_way._suffix > right) ? two_way._suffix : right) + 1;
+	}
+
+	return two_way;
+}
+
+size_t
+_cstr_two_way_search
+(const cstr_two_way_t *two_way, const unsigned char *haystack, size_t haystack_len, const unsigned char *needle, size_t needle_len)
+{
+	size_t suffix = two_way->_suffix;
+	size_t period = two_way->_period;
+	size_t i, j = 0;
+
+	if (needle_len > haystack_len)
+		return CSTR_NPOS;
+
+	if (two_way->_periodic) {
+		size_t memory = 0;
+
+		while (j <= haystack_len - needle_len) {
+			i = (suffix > memory) ? suffix : memory;
+			while ((i < needle_len) && (needle[i] == haystack[i + j]))
+				++i;
+
+			if (needle_len <= i) {
+				i = suffix - 1;
+				while ((memory < i + 1) && (needle[i] == haystack[i + j]))
+					--i;
+
+				if (i + 1 < memory + 1)
+					return j;
+
+				j += period;
+				memory = needle_len - period;
+			}
+			else {
+				j += i - suffix + 1;
+				memory = 0;
+			}
+		}
+	}
+	else {
+		while (j <= haystack_len - needle_len) {
+			i = suffix;
+			while ((i < needle_len) && (needle[i] == haystack[i + j]))
+				++i;
+
+			if (needle_len <= i) {
+				i = suffix - 1;
+				while ((i != SIZE_MAX) && (needle[i] == haystack[i + j]))
+					--i;
+
+				if (i == SIZE_MAX)
+					return j;
+
+				j += period;
+			}
+			else {
+				j += i - suffix + 1;
+			}
+		}
+	}
+
+	return CSTR_NPOS;
+}
+
+#define CSTR_RN(i)	needle[needle_len - 1 - (i)]
+#define CSTR_RH(i)	haystack[haystack_len - 1 - (i)]
+
+size_t
+_cstr_two_way_search_reverse
+(const cstr_two_way_t *two_way, const unsigned char *haystack, size_t haystack_len, const unsigned char *needle, size_t needle_len)
+{
+	size_t suffix = two_way->_suffix;
+	size_t period = two_way->_period;
+	size_t i, j = 0;
+
+	if (needle_len > haystack_len)
+		return CSTR_NPOS;
+
+	if (two_way->_periodic) {
+		size_t memory = 0;
+
+		while (j <= haystack_len - needle_len) {
+			i = (suffix > memory) ? suffix : memory;
+			while ((i < needle_len) && (CSTR_RN(i) == CSTR_RH(i + j)))
+				++i;
+
+			if (needle_len <= i) {
+				i = suffix - 1;
+				while ((memory < i + 1) && (CSTR_RN(i) == CSTR_RH(i + j)))
+					--i;
+
+				if (i + 1 < memory + 1)
+					return (haystack_len - j - needle_len);
+
+				j += period;
+				memory = needle_len - period;
+			}
+			else {
+				j += i - suffix + 1;
+				memory = 0;
+			}
+		}
+	}
+	else {
+		while (j <= haystack_len - needle_len) {
+			i = suffix;
+			while ((i < needle_len) && (CSTR_RN(i) == CSTR_RH(i + j)))
+				++i;
+
+			if (needle_len <= i) {
+				i = suffix - 1;
+				while ((i != SIZE_MAX) && (CSTR_RN(i) == CSTR_RH(i + j)))
+					--i;
+
+				if (i == SIZE_MAX)
+					return (haystack_len - j - needle_len);
+
+				j += period;
+			}
+			else {
+				j += i - suffix + 1;
+			}
+		}
+	}
+
+	return CSTR_NPOS;
+}
+
+#undef CSTR_RN
+#undef CSTR_RH
+
+size_t
+_cstr_two_way
+(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+	cstr_two_way_t two_way = _cstr_two_way_prepare((const unsigned char *)needle, needle_len, false);
+
+	return _cstr_two_way_search(
+		&two_way,
+		(const unsigned char *)haystack, haystack_len,
+		(const unsigned char *)needle, needle_len
+	);
+}
+
+size_t
+_cstr_search_fallback
+(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len, size_t start)
+{
+	size_t offset = _cstr_two_way(haystack + start, haystack_len - start, needle, needle_len);
+
+	return ((offset == CSTR_NPOS) ? CSTR_NPOS : (start + offset));
+}
+
+bool
+_cstr_search_give_up
+(size_t failures, size_t scanned, size_t needle_len)
+{
+	return (needle_len > 3) && (failures > CSTR_SEARCH_MIN_FAILURES) && ((failures << 3) > scanned);
+}
+
+size_t
+_cstr_search_scalar
+(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len, size_t start)
+{
+	size_t limit = haystack_len - needle_len + 1;
+	char first = needle[0];
+	char last = needle[needle_len - 1];
+	size_t failures = 0;
+
+	size_t i = start;
+	while (i < limit) {
+		const char *found = memchr(haystack + i, first, limit - i);
+		if (!found)
+			return CSTR_NPOS;
+
+		i = (size_t)(found - haystack);
+		if ((haystack[i + needle_len - 1] == last) && (memcmp(haystack + i + 1, needle + 1, needle_len - 2) == 0))
+			return i;
+
+		if (_cstr_search_give_up(++failures, i, needle_len))
+			return _cstr_search_fallback(haystack, haystack_len, needle, needle_len, i + 1);
+
+		++i;
+	}
+
+	return CSTR_NPOS;
+}
+
+#if	defined(CSTR_HAS_SSE2)
+
+size_t
+_cstr_search_sse2
+(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+	size_t limit = haystack_len - needle_len + 1;
+	const __m128i first = _mm_set1_epi8(needle[0]);
+	const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+	size_t failures = 0;
+
+	size_t i = 0;
+	for (; i + 16 <= limit; i += 16) {
+		__m128i block_first = _mm_loadu_si128((const __m128i *)(haystack + i));
+		__m128i block_last = _mm_loadu_si128((const __m128i *)(haystack + i + needle_len - 1));
+
+		unsigned mask = (unsigned)_mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last))
+		);
+
+		while (mask) {
+			size_t candidate = i + (size_t)__builtin_ctz(mask);
+			if (memcmp(haystack + candidate + 1, needle + 1, needle_len - 2) == 0)
+				return candidate;
+
+			if (_cstr_search_give_up(++failures, candidate, needle_len))
+				return _cstr_search_fallback(haystack, haystack_len, needle, needle_len, candidate + 1);
+
+			mask &= mask - 1;
+		}
+	}
+
+	return _cstr_search_scalar(haystack, haystack_len, needle, needle_len, i);
+}
+
+__attribute__((target("avx2")))
+size_t
+_cstr_search_avx2
+(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+	size_t limit = haystack_len - needle_len + 1;
+	const __m256i first = _mm256_set1_epi8(needle[0]);
+	const __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+	size_t failures = 0;
+
+	size_t i = 0;
+	for (; i + 32 <= limit; i += 32) {
+		__m256i block_first = _mm256_loadu_si256((const __m256i *)(haystack + i));
+		__m256i block_last = _mm256_loadu_si256((const __m256i *)(haystack + i + needle_len - 1));
+
+		unsigned mask = (unsigned)_mm256_movemask_epi8(
+			_mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last))
+		);
+
+		while (mask) {
+			size_t candidate = i + (size_t)__builtin_ctz(mask);
+			if (memcmp(haystack + candidate + 1, needle + 1, needle_len - 2) == 0)
+				return candidate;
+
+			if (_cstr_search_give_up(++failures, candidate, needle_len))
+				return _cstr_search_fallback(haystack, haystack_len, needle, needle_len, candidate + 1);
+
+			mask &= mask - 1;
+		}
+	}
+
+	return _cstr_search_scalar(haystack, haystack_len, needle, needle_len, i);
+}
+
+#endif
+
+size_t
+_cstr_search_portable
+(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+	return _cstr_search_scalar(haystack, haystack_len, needle, needle_len, 0);
+}
+
+typedef size_t (*cstr_search_fn_t)(const char *, size_t, const char *, size_t);
+
+cstr_search_fn_t
+_cstr_search_resolve
+(void)
+{
+#if	defined(CSTR_HAS_SSE2)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return _cstr_search_avx2;
+
+	return _cstr_search_sse2;
+#else
+	return _cstr_search_portable;
+#endif
+}
+
+size_t
+_cstr_search
+(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+	static _Atomic(cstr_search_fn_t) cached = NULL;
+
+	if (needle_len == 0)
+		return 0;
+
+	if (needle_len > haystack_len)
+		return CSTR_NPOS;
+
+	if (needle_len == 1) {
+		const char *found = memchr(haystack, needle[0], haystack_len);
+		return (found ? (size_t)(found - haystack) : CSTR_NPOS);
+	}
+
+	cstr_search_fn_t search = atomic_load_explicit(&cached, memory_order_acquire);
+	if (!search) {
+		search = _cstr_search_resolve();
+		atomic_store_explicit(&cached, search, memory_order_release);
+	}
+
+	return search(haystack, haystack_len, needle, needle_len);
+}
+
+size_t
+_cstr_find_at
+(string_t string, size_t pos, const char *needle, size_t needle_len)
+{
+	size_t offset = _cstr_search(string + pos, _cstr_get_size(string) - pos, needle, needle_len);
+
+	return ((offset == CSTR_NPOS) ? CSTR_NPOS : (pos + offset));
+}
+
+size_t
+_cstr_two_way_reverse
+(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+	cstr_two_way_t two_way = _cstr_two_way_prepare((const unsigned char *)needle, needle_len, true);
+
+	return _cstr_two_way_search_reverse(
+		&two_way,
+		(const unsigned char *)haystack, haystack_len,
+		(const unsigned char *)needle, needle_len
+	);
+}
+
+const char *
+_cstr_memrchr
+(const char *string, char c, size_t len)
+{
+#if	defined(__GLIBC__)
+	return memrchr(string, c, len);
+#else
+	while (len-- > 0)
+		if (string[len] == c)
+			return (string + len);
+
+	return NULL;
+#endif
+}
+
+size_t
+_cstr_rsearch_scalar
+(const char *haystack, const char *needle, size_t needle_len, size_t end)
+{
+	char first = needle[0];
+	char last = needle[needle_len - 1];
+	size_t failures = 0;
+	size_t scanned = 0;
+
+	size_t i = end;
+	while (i > 0) {
+		const char *found = _cstr_memrchr(haystack, first, i);
+		if (!found)
+			return CSTR_NPOS;
+
+		size_t candidate = (size_t)(found - haystack);
+		if ((haystack[candidate + needle_len - 1] == last) && (memcmp(haystack + candidate + 1, needle + 1, needle_len - 2) == 0))
+			return candidate;
+
+		scanned += i - candidate;
+		if (_cstr_search_give_up(++failures, scanned, needle_len))
+			return _cstr_two_way_reverse(haystack, candidate + needle_len - 1, needle, needle_len);
+
+		i = candidate;
+	}
+
+	return CSTR_NPOS;
+}
+
+#if	defined(CSTR_HAS_SSE2)
+
+size_t
+_cstr_rsearch_sse2
+(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+	size_t end = haystack_len - needle_len + 1;
+	const __m128i first = _mm_set1_epi8(needle[0]);
+	const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+	size_t failures = 0;
+
+	size_t i = end;
+	for (; i >= 16; i -= 16) {
+		__m128i block_first = _mm_loadu_si128((const __m128i *)(haystack + i - 16));
+		__m128i block_last = _mm_loadu_si128((const __m128i *)(haystack + i - 16 + needle_len - 1));
+
+		unsigned mask = (unsigned)_mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last))
+		);
+
+		while (mask) {
+			unsigned bit = 31u - (unsigned)__builtin_clz(mask);
+			size_t candidate = i - 16 + bit;
+			if (memcmp(haystack + candidate + 1, needle + 1, needle_len - 2) == 0)
+				return candidate;
+
+			if (_cstr_search_give_up(++failures, end - candidate, needle_len))
+				return _cstr_two_way_reverse(haystack, candidate + needle_len - 1, needle, needle_len);
+
+			mask &= ~(1u << bit);
+		}
+	}
+
+	return _cstr_rsearch_scalar(haystack, needle, needle_len, i);
+}
+
+__attribute__((target("avx2")))
+size_t
+_cstr_rsearch_avx2
+(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+	size_t end = haystack_len - needle_len + 1;
+	const __m256i first = _mm256_set1_epi8(needle[0]);
+	const __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+	size_t failures = 0;
+
+	size_t i = end;
+	for (; i >= 32; i -= 32) {
+		__m256i block_first = _mm256_loadu_si256((const __m256i *)(haystack + i - 32));
+		__m256i block_last = _mm256_loadu_si256((const __m256i *)(haystack + i - 32 + needle_len - 1));
+
+		unsigned mask = (unsigned)_mm256_movemask_epi8(
+			_mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last))
+		);
+
+		while (mask) {
+			unsigned bit = 31u - (unsigned)__builtin_clz(mask);
+			size_t candidate = i - 32 + bit;
+			if (memcmp(haystack + candidate + 1, needle + 1, needle_len - 2) == 0)
+				return candidate;
+
+			if (_cstr_search_give_up(++failures, end - candidate, needle_len))
+				return _cstr_two_way_reverse(haystack, candidate + needle_len - 1, needle, needle_len);
+
+			mask &= ~(1u << bit);
+		}
+	}
+
+	return _cstr_rsearch_scalar(haystack, needle, needle_len, i);
+}
+
+#endif
+
+size_t
+_cstr_rsearch_portable
+(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+	return _cstr_rsearch_scalar(haystack, needle, needle_len, haystack_len - needle_len + 1);
+}
+
+cstr_search_fn_t
+_cstr_rsearch_resolve
+(void)
+{
+#if	defined(CSTR_HAS_SSE2)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return _cstr_rsearch_avx2;
+
+	return _cstr_rsearch_sse2;
+#else
+	return _cstr_rsearch_portable;
+#endif
+}
+
+size_t
+_cstr_rsearch
+(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+	static _Atomic(cstr_search_fn_t) cached = NULL;
+
+	if (needle_len > haystack_len)
+		return CSTR_NPOS;
+
+	if (needle_len == 0)
+		return haystack_len;
+
+	if (needle_len == 1) {
+		const char *found = _cstr_memrchr(haystack, needle[0], haystack_len);
+		return (found ? (size_t)(found - haystack) : CSTR_NPOS);
+	}
+
+	cstr_search_fn_t search = atomic_load_explicit(&cached, memory_order_acquire);
+	if (!search) {
+		search = _cstr_rsearch_resolve();
+		atomic_store_explicit(&cached, search, memory_order_release);
+	}
+
+	return search(haystack, haystack_len, needle, needle_len);
+}
+
+size_t
+_cstr_rfind_at
+(string_t string, size_t pos, const char *needle, size_t needle_len)
+{
+	size_t size = _cstr_get_size(string);
+	if (needle_len > size)
+		return CSTR_NPOS;
+
+	size_t start = ((pos < size - needle_len) ? pos : (size - needle_len));
+	return _cstr_rsearch(string, start + needle_len, needle, needle_len);
+}
+
+size_t
+_cstr_count_byte_scalar
+(const char *string, size_t len, char c)
+{
+	size_t count = 0;
+
+	for (size_t i = 0; i < len; ++i)
+		count += (string[i] == c);
+
+	return count;
+}
+
+#if	defined(CSTR_HAS_SSE2)
+
+size_t
+_cstr_count_byte_sse2
+(const char *string, size_t len, char c)
+{
+	const __m128i target = _mm_set1_epi8(c);
+	size_t count = 0;
+
+	size_t i = 0;
+	for (; i + 16 <= len; i += 16) {
+		__m128i block = _mm_loadu_si128((const __m128i *)(string + i));
+		count += (size_t)__builtin_popcount((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, target)));
+	}
+
+	return count + _cstr_count_byte_scalar(string + i, len - i, c);
+}
+
+__attribute__((target("avx2,popcnt")))
+size_t
+_cstr_count_byte_avx2
+(const char *string, size_t len, char c)
+{
+	const __m256i target = _mm256_set1_epi8(c);
+	size_t count = 0;
+
+	size_t i = 0;
+	for (; i + 32 <= len; i += 32) {
+		__m256i block = _mm256_loadu_si256((const __m256i *)(string + i));
+		count += (size_t)__builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, target)));
+	}
+
+	return count + _cstr_count_byte_scalar(string + i, len - i, c);
+}
+
+#endif
+
+typedef size_t (*cstr_count_fn_t)(const char *, size_t, char);
+
+cstr_count_fn_t
+_cstr_count_byte_resolve
+(void)
+{
+#if	defined(CSTR_HAS_SSE2)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+		return _cstr_count_byte_avx2;
+
+	return _cstr_count_byte_sse2;
+#else
+	return _cstr_count_byte_scalar;
+#endif
+}
+
+size_t
+_cstr_count_byte
+(const char *string, size_t len, char c)
+{
+	static _Atomic(cstr_count_fn_t) cached = NULL;
+
+	cstr_count_fn_t count = atomic_load_explicit(&cached, memory_order_acquire);
+	if (!count) {
+		count = _cstr_count_byte_resolve();
+		atomic_store_explicit(&cached, count, memory_order_release);
+	}
+
+	return count(string, len, c);
+}
+
+size_t
+_cstr_find_all_at
+(string_t string, const char *needle, size_t needle_len, size_t *positions, size_t cap, cstr_match_mode_t mode)
+{
+	size_t size = _cstr_get_size(string);
+	size_t step = ((mode == CSTR_MATCH_OVERLAP) || (needle_len == 0)) ? 1 : needle_len;
+	size_t count = 0;
+
+	size_t pos = 0;
+	while (pos <= size) {
+		size_t found = _cstr_find_at(string, pos, needle, needle_len);
+		if (found == CSTR_NPOS)
+			break;
+
+		if (count < cap)
+			positions[count] = found;
+		++count;
+
+		pos = found + step;
+	}
+
+	return count;
+}
+
+struct cstr_searcher_t
+{
+	const cstr_allocator_t *	_allocator;
+	size_t						_len;
+	size_t						_rare[2];
+	cstr_two_way_t				_forward;
+	cstr_two_way_t				_reverse;
+	uint32_t					_shift[256];
+	uint32_t					_rshift[256];
+	char						_needle[];
+};
+
+unsigned
+_cstr_byte_rank
+(unsigned char c)
+{
+	static const char common[] = " etaoinsrhldcumfpgwybvkxjqz";
+
+	const char *hit = memchr(common, c, sizeof(common) - 1);
+	if (hit)
+		return (255u - (unsigned)(hit - common));
+
+	if ((c >= 'A') && (c <= 'Z'))
+		return 192;
+
+	if ((c >= '0') && (c <= '9'))
+		return 184;
+
+	if ((c > ' ') && (c < 0x7F))
+		return 176;
+
+	if ((c == '\n') || (c == '\r') || (c == '\t'))
+		return 168;
+
+	return 64;
+}
+
+void
+_cstr_searcher_prepare
+(cstr_searcher_t *searcher)
+{
+	const unsigned char *needle = (const unsigned char *)searcher->_needle;
+	size_t len = searcher->_len;
+	uint32_t limit = (len < UINT32_MAX) ? (uint32_t)len : UINT32_MAX;
+
+	for (size_t c = 0; c < 256; ++c)
+		searcher->_shift[c] = searcher->_rshift[c] = limit;
+
+	for (size_t i = 0; i + 1 < len; ++i) {
+		size_t shift = len - 1 - i;
+		searcher->_shift[needle[i]] = (shift < limit) ? (uint32_t)shift : limit;
+	}
+
+	for (size_t i = len; i > 1; --i) {
+		size_t shift = i - 1;
+		searcher->_rshift[needle[i - 1]] = (shift < limit) ? (uint32_t)shift : limit;
+	}
+
+	if (len < 2) {
+		searcher->_rare[0] = searcher->_rare[1] = 0;
+		return;
+	}
+
+	size_t rare = 0;
+	for (size_t i = 1; i < len; ++i)
+		if (_cstr_byte_rank(needle[i]) < _cstr_byte_rank(needle[rare]))
+			rare = i;
+
+	size_t other = (rare == 0) ? (len - 1) : 0;
+	for (size_t i = 0; i < len; ++i) {
+		if ((needle[i] == needle[rare]) || (i == rare))
+			continue;
+
+		if ((needle[other] == needle[rare]) || (_cstr_byte_rank(needle[i]) < _cstr_byte_rank(needle[other])))
+			other = i;
+	}
+
+	searcher->_rare[0] = rare;
+	searcher->_rare[1] = other;
+
+	searcher->_forward = _cstr_two_way_prepare(needle, len, false);
+	searcher->_reverse = _cstr_two_way_prepare(needle, len, true);
+}
+
+size_t
+_cstr_searcher_two_way
+(const cstr_searcher_t *searcher, const char *haystack, size_t haystack_len, size_t start)
+{
+	size_t offset = _cstr_two_way_search(
+		&searcher->_forward,
+		(const unsigned char *)haystack + start, haystack_len - start,
+		(const unsigned char *)searcher->_needle, searcher->_len
+	);
+
+	return ((offset == CSTR_NPOS) ? CSTR_NPOS : (start + offset));
+}
+
+size_t
+_cstr_searcher_two_way_reverse
+(const cstr_searcher_t *searcher, const char *haystack, size_t haystack_len)
+{
+	return _cstr_two_way_search_reverse(
+		&searcher->_reverse,
+		(const unsigned char *)haystack, haystack_len,
+		(const unsigned char *)searcher->_needle, searcher->_len
+	);
+}
+
+size_t
+_cstr_searcher_horspool
+(const cstr_searcher_t *searcher, const char *haystack, size_t haystack_len, size_t start)
+{
+	const unsigned char *needle = (const unsigned char *)searcher->_needle;
+	size_t len = searcher->_len;
+	unsigned char last = needle[len - 1];
+	size_t failures = 0;
+
+	size_t i = start;
+	while (i + len <= haystack_len) {
+		unsigned char tail = (unsigned char)haystack[i + len - 1];
+
+		if (tail == last) {
+			if (memcmp(haystack + i, needle, len - 1) == 0)
+				return i;
+
+			if (_cstr_search_give_up(++failures, i - start, len))
+				return _cstr_searcher_two_way(searcher, haystack, haystack_len, i + 1);
+		}
+
+		i += searcher->_shift[tail];
+	}
+
+	return CSTR_NPOS;
+}
+
+size_t
+_cstr_searcher_horspool_reverse
+(const cstr_searcher_t *searcher, const char *haystack, size_t end)
+{
+	const unsigned char *needle = (const unsigned char *)searcher->_needle;
+	size_t len = searcher->_len;
+	unsigned char first = needle[0];
+	size_t failures = 0;
+
+	size_t i = end;
+	while (i > 0) {
+		size_t candidate = i - 1;
+		unsigned char head = (unsigned char)haystack[candidate];
+
+		if (head == first) {
+			if (memcmp(haystack + candidate + 1, needle + 1, len - 1) == 0)
+				return candidate;
+
+			if (_cstr_search_give_up(++failures, end - candidate, len))
+				return _cstr_searcher_two_way_reverse(searcher, haystack, candidate + len - 1);
+		}
+
+		size_t shift = searcher->_rshift[head];
+		if (shift > candidate)
+			break;
+
+		i -= shift;
+	}
+
+	return CSTR_NPOS;
+}
+
+#if	defined(CSTR_HAS_SSE2)
+
+size_t
+_cstr_searcher_sse2
+(const cstr_searcher_t *searcher, const char *haystack, size_t haystack_len)
+{
+	size_t len = searcher->_len;
+	size_t rare0 = searcher->_rare[0];
+	size_t rare1 = searcher->_rare[1];
+	size_t limit = haystack_len - len + 1;
+	const __m128i byte0 = _mm_set1_epi8(searcher->_needle[rare0]);
+	const __m128i byte1 = _mm_set1_epi8(searcher->_needle[rare1]);
+	size_t failures = 0;
+
+	size_t i = 0;
+	for (; i + 16 <= limit; i += 16) {
+		__m128i block0 = _mm_loadu_si128((const __m128i *)(haystack + i + rare0));
+		__m128i block1 = _mm_loadu_si128((const __m128i *)(haystack + i + rare1));
+
+		unsigned mask = (unsigned)_mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(byte0, block0), _mm_cmpeq_epi8(byte1, block1))
+		);
+
+		while (mask) {
+			size_t candidate = i + (size_t)__builtin_ctz(mask);
+			if (memcmp(haystack + candidate, searcher->_needle, len) == 0)
+				return candidate;
+
+			if (_cstr_search_give_up(++failures, candidate, len))
+				return _cstr_searcher_two_way(searcher, haystack, haystack_len, candidate + 1);
+
+			mask &= mask - 1;
+		}
+	}
+
+	return _cstr_searcher_horspool(searcher, haystack, haystack_len, i);
+}
+
+size_t
+_cstr_searcher_reverse_sse2
+(const cstr_searcher_t *searcher, const char *haystack, size_t haystack_len)
+{
+	size_t len = searcher->_len;
+	size_t rare0 = searcher->_rare[0];
+	size_t rare1 = searcher->_rare[1];
+	size_t end = haystack_len - len + 1;
+	const __m128i byte0 = _mm_set1_epi8(searcher->_needle[rare0]);
+	const __m128i byte1 = _mm_set1_epi8(searcher->_needle[rare1]);
+	size_t failures = 0;
+
+	size_t i = end;
+	for (; i >= 16; i -= 16) {
+		__m128i block0 = _mm_loadu_si128((const __m128i *)(haystack + i - 16 + rare0));
+		__m128i block1 = _mm_loadu_si128((const __m128i *)(haystack + i - 16 + rare1));
+
+		unsigned mask = (unsigned)_mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(byte0, block0), _mm_cmpeq_epi8(byte1, block1))
+		);
+
+		while (mask) {
+			unsigned bit = 31u - (unsigned)__builtin_clz(mask);
+			size_t candidate = i - 16 + bit;
+			if (memcmp(haystack + candidate, searcher->_needle, len) == 0)
+				return candidate;
+
+			if (_cstr_search_give_up(++failures, end - candidate, len))
+				return _cstr_searcher_two_way_reverse(searcher, haystack, candidate + len - 1);
+
+			mask &= ~(1u << bit);
+		}
+	}
+
+	return _cstr_searcher_horspool_reverse(searcher, haystack, i);
+}
+
+__attribute__((target("avx2")))
+size_t
+_cstr_searcher_avx2
+(const cstr_searcher_t *searcher, const char *haystack, size_t haystack_len)
+{
+	size_t len = searcher->_len;
+	size_t rare0 = searcher->_rare[0];
+	size_t rare1 = searcher->_rare[1];
+	size_t limit = haystack_len - len + 1;
+	const __m256i byte0 = _mm256_set1_epi8(searcher->_needle[rare0]);
+	const __m256i byte1 = _mm256_set1_epi8(searcher->_needle[rare1]);
+	size_t failures = 0;
+
+	size_t i = 0;
+	for (; i + 32 <= limit; i += 32) {
+		__m256i block0 = _mm256_loadu_si256((const __m256i *)(haystack + i + rare0));
+		__m256i block1 = _mm256_loadu_si256((const __m256i *)(haystack + i + rare1));
+
+		unsigned mask = (unsigned)_mm256_movemask_epi8(
+			_mm256_and_si256(_mm256_cmpeq_epi8(byte0, block0), _mm256_cmpeq_epi8(byte1, block1))
+		);
+
+		while (mask) {
+			size_t candidate = i + (size_t)__builtin_ctz(mask);
+			if (memcmp(haystack + candidate, searcher->_needle, len) == 0)
+				return candidate;
+
+			if (_cstr_search_give_up(++failures, candidate, len))
+				return _cstr_searcher_two_way(searcher, haystack, haystack_len, candidate + 1);
+
+			mask &= mask - 1;
+		}
+	}
+
+	return _cstr_searcher_horspool(searcher, haystack, haystack_len, i);
+}
+
+__attribute__((target("avx2")))
+size_t
+_cstr_searcher_reverse_avx2
+(const cstr_searcher_t *searcher, const char *haystack, size_t haystack_len)
+{
+	size_t len = searcher->_len;
+	size_t rare0 = searcher->_rare[0];
+	size_t rare1 = searcher->_rare[1];
+	size_t end = haystack_len - len + 1;
+	const __m256i byte0 = _mm256_set1_epi8(searcher->_needle[rare0]);
+	const __m256i byte1 = _mm256_set1_epi8(searcher->_needle[rare1]);
+	size_t failures = 0;
+
+	size_t i = end;
+	for (; i >= 32; i -= 32) {
+		__m256i block0 = _mm256_loadu_si256((const __m256i *)(haystack + i - 32 + rare0));
+		__m256i block1 = _mm256_loadu_si256((const __m256i *)(haystack + i - 32 + rare1));
+
+		unsigned mask = (unsigned)_mm256_movemask_epi8(
+			_mm256_and_si256(_mm256_cmpeq_epi8(byte0, block0), _mm256_cmpeq_epi8(byte1, block1))
+		);
+
+		while (mask) {
+			unsigned bit = 31u - (unsigned)__builtin_clz(mask);
+			size_t candidate = i - 32 + bit;
+			if (memcmp(haystack + candidate, searcher->_needle, len) == 0)
+				return candidate;
+
+			if (_cstr_search_give_up(++failures, end - candidate, len))
+				return _cstr_searcher_two_way_reverse(searcher, haystack, candidate + len - 1);
+
+			mask &= ~(1u << bit);
+		}
+	}
+
+	return _cstr_searcher_horspool_reverse(searcher, haystack, i);
+}
+
+#endif
+
+size_t
+_cstr_searcher_portable
+(const cstr_searcher_t *searcher, const char *haystack, size_t haystack_len)
+{
+	return _cstr_searcher_horspool(searcher, haystack, haystack_len, 0);
+}
+
+size_t
+_cstr_searcher_reverse_portable
+(const cstr_searcher_t *searcher, const char *haystack, size_t haystack_len)
+{
+	return _cstr_searcher_horspool_reverse(searcher, haystack, haystack_len - searcher->_len + 1);
+}
+
+typedef size_t (*cstr_searcher_fn_t)(const cstr_searcher_t *, const char *, size_t);
+
+cstr_searcher_fn_t
+_cstr_searcher_resolve
+(bool reverse)
+{
+#if	defined(CSTR_HAS_SSE2)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return (reverse ? _cstr_searcher_reverse_avx2 : _cstr_searcher_avx2);
+
+	return (reverse ? _cstr_searcher_reverse_sse2 : _cstr_searcher_sse2);
+#else
+	return (reverse ? _cstr_searcher_reverse_portable : _cstr_searcher_portable);
+#endif
+}
+
+size_t
+_cstr_searcher_search
+(const cstr_searcher_t *searcher, const char *haystack, size_t haystack_len)
+{
+	static _Atomic(cstr_searcher_fn_t) cached = NULL;
+	size_t len = searcher->_len;
+
+	if (len == 0)
+		return 0;
+
+	if (len > haystack_len)
+		return CSTR_NPOS;
+
+	if (len == 1) {
+		const char *found = memchr(haystack, searcher->_needle[0], haystack_len);
+		return (found ? (size_t)(found - haystack) : CSTR_NPOS);
+	}
+
+	cstr_searcher_fn_t search = atomic_load_explicit(&cached, memory_order_acquire);
+	if (!search) {
+		search = _cstr_searcher_resolve(false);
+		atomic_store_explicit(&cached, search, memory_order_release);
+	}
+
+	return search(searcher, haystack, haystack_len);
+}
+
+size_t
+_cstr_searcher_rsearch
+(const cstr_searcher_t *searcher, const char *haystack, size_t haystack_len)
+{
+	static _Atomic(cstr_searcher_fn_t) cached = NULL;
+	size_t len = searcher->_len;
+
+	if (len > haystack_len)
+		return CSTR_NPOS;
+
+	if (len == 0)
+		return haystack_len;
+
+	if (len == 1) {
+		const char *found = _cstr_memrchr(haystack, searcher->_needle[0], haystack_len);
+		return (found ? (size_t)(found - haystack) : CSTR_NPOS);
+	}
+
+	cstr_searcher_fn_t search = atomic_load_explicit(&cached, memory_order_acquire);
+	if (!search) {
+		search = _cstr_searcher_resolve(true);
+		atomic_store_explicit(&cached, search, memory_order_release);
+	}
+
+	return search(searcher, haystack, haystack_len);
+}
+
+bool
+_cstr_charset_test
+(const cstr_charset_t *charset, unsigned char c)
+{
+	return ((charset->_bitmap[c >> 3] >> (c & 7)) & 1) != 0;
+}
+
+size_t
+_cstr_charset_first_scalar
+(const cstr_charset_t *charset, const char *string, size_t from, size_t to, bool match)
+{
+	for (size_t i = from; i < to; ++i)
+		if (_cstr_charset_test(charset, (unsigned char)string[i]) == match)
+			return i;
+
+	return CSTR_NPOS;
+}
+
+size_t
+_cstr_charset_last_scalar
+(const cstr_charset_t *charset, const char *string, size_t from, size_t to, bool match)
+{
+	for (size_t i = to; i > from; --i)
+		if (_cstr_charset_test(charset, (unsigned char)string[i - 1]) == match)
+			return (i - 1);
+
+	return CSTR_NPOS;
+}
+
+#if	defined(CSTR_HAS_SSE2)
+
+__attribute__((target("ssse3")))
+unsigned
+_cstr_charset_mask_ssse3
+(__m128i low_rows, __m128i high_rows, __m128i bits, const char *block)
+{
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+	const __m128i eight = _mm_set1_epi8(8);
+
+	__m128i input = _mm_loadu_si128((const __m128i *)block);
+	__m128i low = _mm_and_si128(input, nibble);
+	__m128i high = _mm_and_si128(_mm_srli_epi16(input, 4), nibble);
+
+	__m128i select = _mm_cmplt_epi8(high, eight);
+	__m128i row = _mm_or_si128(
+		_mm_and_si128(select, _mm_shuffle_epi8(low_rows, low)),
+		_mm_andnot_si128(select, _mm_shuffle_epi8(high_rows, low))
+	);
+	__m128i bit = _mm_shuffle_epi8(bits, high);
+
+	return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), bit));
+}
+
+__attribute__((target("ssse3")))
+size_t
+_cstr_charset_first_ssse3
+(const cstr_charset_t *charset, const char *string, size_t from, size_t to, bool match)
+{
+	const __m128i low_rows = _mm_loadu_si128((const __m128i *)charset->_low);
+	const __m128i high_rows = _mm_loadu_si128((const __m128i *)charset->_high);
+	const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+	const unsigned flip = match ? 0 : 0xFFFF;
+
+	size_t i = from;
+	for (; i + 16 <= to; i += 16) {
+		unsigned mask = _cstr_charset_mask_ssse3(low_rows, high_rows, bits, string + i) ^ flip;
+		if (mask)
+			return (i + (size_t)__builtin_ctz(mask));
+	}
+
+	return _cstr_charset_first_scalar(charset, string, i, to, match);
+}
+
+__attribute__((target("ssse3")))
+size_t
+_cstr_charset_last_ssse3
+(const cstr_charset_t *charset, const char *string, size_t from, size_t to, bool match)
+{
+	const __m128i low_rows = _mm_loadu_si128((const __m128i *)charset->_low);
+	const __m128i high_rows = _mm_loadu_si128((const __m128i *)charset->_high);
+	const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+	const unsigned flip = match ? 0 : 0xFFFF;
+
+	size_t i = to;
+	for (; i >= from + 16; i -= 16) {
+		unsigned mask = _cstr_charset_mask_ssse3(low_rows, high_rows, bits, string + i - 16) ^ flip;
+		if (mask)
+			return (i - 16 + (31u - (unsigned)__builtin_clz(mask)));
+	}
+
+	return _cstr_charset_last_scalar(charset, string, from, i, match);
+}
+
+__attribute__((target("avx2")))
+unsigned
+_cstr_charset_mask_avx2
+(__m256i low_rows, __m256i high_rows, __m256i bits, const char *block)
+{
+	const __m256i nibble = _mm256_set1_epi8(0x0F);
+	const __m256i eight = _mm256_set1_epi8(8);
+
+	__m256i input = _mm256_loadu_si256((const __m256i *)block);
+	__m256i low = _mm256_and_si256(input, nibble);
+	__m256i high = _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble);
+
+	__m256i select = _mm256_cmpgt_epi8(eight, high);
+	__m256i row = _mm256_blendv_epi8(
+		_mm256_shuffle_epi8(high_rows, low),
+		_mm256_shuffle_epi8(low_rows, low),
+		select
+	);
+	__m256i bit = _mm256_shuffle_epi8(bits, high);
+
+	return (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit));
+}
+
+__attribute__((target("avx2")))
+size_t
+_cstr_charset_first_avx2
+(const cstr_charset_t *charset, const char *string, size_t from, size_t to, bool match)
+{
+	const __m256i low_rows = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)charset->_low));
+	const __m256i high_rows = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)charset->_high));
+	const __m256i bits = _mm256_setr_epi8(
+		1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+		1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128
+	);
+	const unsigned flip = match ? 0 : 0xFFFFFFFFu;
+
+	size_t i = from;
+	for (; i + 32 <= to; i += 32) {
+		unsigned mask = _cstr_charset_mask_avx2(low_rows, high_rows, bits, string + i) ^ flip;
+		if (mask)
+			return (i + (size_t)__builtin_ctz(mask));
+	}
+
+	return _cstr_charset_first_scalar(charset, string, i, to, match);
+}
+
+__attribute__((target("avx2")))
+size_t
+_cstr_charset_last_avx2
+(const cstr_charset_t *charset, const char *string, size_t from, size_t to, bool match)
+{
+	const __m256i low_rows = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)charset->_low));
+	const __m256i high_rows = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)charset->_high));
+	const __m256i bits = _mm256_setr_epi8(
+		1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+		1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128
+	);
+	const unsigned flip = match ? 0 : 0xFFFFFFFFu;
+
+	size_t i = to;
+	for (; i >= from + 32; i -= 32) {
+		unsigned mask = _cstr_charset_mask_avx2(low_rows, high_rows, bits, string + i - 32) ^ flip;
+		if (mask)
+			return (i - 32 + (31u - (unsigned)__builtin_clz(mask)));
+	}
+
+	return _cstr_charset_last_scalar(charset, string, from, i, match);
+}
+
+#endif
+
+typedef size_t (*cstr_charset_fn_t)(const cstr_charset_t *, const char *, size_t, size_t, bool);
+
+_Atomic(cstr_charset_fn_t) _cstr_charset_first_fn = NULL;
+_Atomic(cstr_charset_fn_t) _cstr_charset_last_fn = NULL;
+
+void
+_cstr_charset_resolve
+(void)
+{
+	cstr_charset_fn_t first = _cstr_charset_first_scalar;
+	cstr_charset_fn_t last = _cstr_charset_last_scalar;
+
+#if	defined(CSTR_HAS_SSE2)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		first = _cstr_charset_first_avx2;
+		last = _cstr_charset_last_avx2;
+	}
+	else if (__builtin_cpu_supports("ssse3")) {
+		first = _cstr_charset_first_ssse3;
+		last = _cstr_charset_last_ssse3;
+	}
+#endif
+
+	atomic_store_explicit(&_cstr_charset_last_fn, last, memory_order_release);
+	atomic_store_explicit(&_cstr_charset_first_fn, first, memory_order_release);
+}
+
+cstr_charset_fn_t
+_cstr_charset_first_kernel
+(void)
+{
+	cstr_charset_fn_t first = atomic_load_explicit(&_cstr_charset_first_fn, memory_order_acquire);
+	if (!first) {
+		_cstr_charset_resolve();
+		first = atomic_load_explicit(&_cstr_charset_first_fn, memory_order_acquire);
+	}
+
+	return first;
+}
+
+cstr_charset_fn_t
+_cstr_charset_last_kernel
+(void)
+{
+	cstr_charset_fn_t last = atomic_load_explicit(&_cstr_charset_last_fn, memory_order_acquire);
+	if (!last) {
+		_cstr_charset_resolve();
+		last = atomic_load_explicit(&_cstr_charset_last_fn, memory_order_acquire);
+	}
+
+	return last;
+}
+
+size_t
+_cstr_charset_first
+(const cstr_charset_t *charset, string_t string, size_t pos, bool match)
+{
+	return _cstr_charset_first_kernel()(charset, string, pos, _cstr_get_size(string), match);
+}
+
+size_t
+_cstr_charset_last
+(const cstr_charset_t *charset, string_t string, size_t pos, bool match)
+{
+	return _cstr_charset_last_kernel()(charset, string, pos, _cstr_get_size(string), match);
+}
+
+struct cstr_multimatcher_t
+{
+	const cstr_allocator_t *	_allocator;
+
+	size_t						_count;
+	size_t						_min_len;
+	size_t						_max_len;
+	size_t *					_lens;
+	size_t *					_offsets;
+	char *						_text;
+	size_t						_text_size;
+
+	uint16_t					_class_of[256];
+	size_t						_classes;
+	size_t						_states;
+	uint32_t *					_delta;
+	uint32_t *					_out_start;
+	uint32_t *					_outputs;
+	size_t						_output_count;
+
+	cstr_charset_t				_first;
+	bool						_skip;
+
+	bool						_teddy;
+	size_t						_teddy_len;
+	uint8_t						_teddy_low[CSTR_TEDDY_FINGERPRINT][16];
+	uint8_t						_teddy_high[CSTR_TEDDY_FINGERPRINT][16];
+};
+
+void *
+_cstr_multimatcher_alloc
+(const cstr_multimatcher_t *matcher, size_t size)
+{
+	void *block = matcher->_allocator->alloc(matcher->_allocator->context, size);
+	assert(block && "failed to allocate multimatcher!");
+
+	return block;
+}
+
+void
+_cstr_multimatcher_free
+(const cstr_multimatcher_t *matcher, void *block, size_t size)
+{
+	if (block)
+		matcher->_allocator->free(matcher->_allocator->context, block, size);
+}
+
+void
+_cstr_multimatcher_build_dfa
+(cstr_multimatcher_t *matcher)
+{
+	size_t classes = 1;
+	memset(matcher->_class_of, 0, sizeof(matcher->_class_of));
+
+	for (size_t i = 0; i < matcher->_text_size; ++i) {
+		unsigned char byte = (unsigned char)matcher->_text[i];
+		if (!matcher->_class_of[byte])
+			matcher->_class_of[byte] = (uint16_t)classes++;
+	}
+	matcher->_classes = classes;
+
+	size_t capacity = matcher->_text_size + 1;
+	uint32_t *delta = _cstr_multimatcher_alloc(matcher, capacity * classes * sizeof(uint32_t));
+	uint32_t *fail = _cstr_multimatcher_alloc(matcher, capacity * sizeof(uint32_t));
+	uint32_t *queue = _cstr_multimatcher_alloc(matcher, capacity * sizeof(uint32_t));
+	uint32_t *own = _cstr_multimatcher_alloc(matcher, capacity * sizeof(uint32_t));
+	uint32_t *next = _cstr_multimatcher_alloc(matcher, matcher->_count * sizeof(uint32_t));
+	uint32_t *counts = _cstr_multimatcher_alloc(matcher, capacity * sizeof(uint32_t));
+
+	memset(delta, 0, capacity * classes * sizeof(uint32_t));
+	memset(own, 0xFF, capacity * sizeof(uint32_t));
+
+	size_t states = 1;
+	for (size_t p = 0; p < matcher->_count; ++p) {
+		const unsigned char *pattern = (const unsigned char *)matcher->_text + matcher->_offsets[p];
+		uint32_t state = 0;
+
+		for (size_t i = 0; i < matcher->_lens[p]; ++i) {
+			uint32_t *edge = &delta[state * classes + matcher->_class_of[pattern[i]]];
+			if (!*edge)
+				*edge = (uint32_t)states++;
+			state = *edge;
+		}
+
+		next[p] = own[state];
+		own[state] = (uint32_t)p;
+	}
+
+	size_t head = 0, tail = 0;
+	fail[0] = 0;
+	queue[tail++] = 0;
+
+	while (head < tail) {
+		uint32_t state = queue[head++];
+		uint32_t *row = &delta[state * classes];
+		const uint32_t *fallback = &delta[fail[state] * classes];
+
+		for (size_t c = 1; c < classes; ++c) {
+			if (!row[c]) {
+				row[c] = (state ? fallback[c] : 0);
+				continue;
+			}
+
+			fail[row[c]] = (state ? fallback[c] : 0);
+			queue[tail++] = row[c];
+		}
+	}
+
+	size_t total = 0;
+	for (size_t i = 0; i < states; ++i) {
+		uint32_t state = queue[i];
+		uint32_t count = (state ? counts[fail[state]] : 0);
+
+		for (uint32_t p = own[state]; p != UINT32_MAX; p = next[p])
+			++count;
+
+		counts[state] = count;
+		total += count;
+	}
+
+	uint32_t *out_start = _cstr_multimatcher_alloc(matcher, (states + 1) * sizeof(uint32_t));
+	uint32_t *outputs = _cstr_multimatcher_alloc(matcher, (total ? total : 1) * sizeof(uint32_t));
+
+	out_start[0] = 0;
+	for (size_t s = 0; s < states; ++s)
+		out_start[s + 1] = out_start[s] + counts[s];
+
+	for (size_t i = 0; i < states; ++i) {
+		uint32_t state = queue[i];
+		uint32_t at = out_start[state];
+
+		for (uint32_t p = own[state]; p != UINT32_MAX; p = next[p])
+			outputs[at++] = p;
+
+		if (state) {
+			for (uint32_t o = out_start[fail[state]]; o < out_start[fail[state] + 1]; ++o)
+				outputs[at++] = outputs[o];
+		}
+	}
+
+	if (states < capacity) {
+		const cstr_allocator_t *allocator = matcher->_allocator;
+		uint32_t *shrunk = allocator->realloc(
+			allocator->context, delta,
+			capacity * classes * sizeof(uint32_t), states * classes * sizeof(uint32_t)
+		);
+
+		assert(shrunk && "failed to shrink multimatcher table!");
+		delta = shrunk;
+	}
+
+	_cstr_multimatcher_free(matcher, fail, capacity * sizeof(uint32_t));
+	_cstr_multimatcher_free(matcher, queue, capacity * sizeof(uint32_t));
+	_cstr_multimatcher_free(matcher, own, capacity * sizeof(uint32_t));
+	_cstr_multimatcher_free(matcher, next, matcher->_count * sizeof(uint32_t));
+	_cstr_multimatcher_free(matcher, counts, capacity * sizeof(uint32_t));
+
+	matcher->_states = states;
+	matcher->_delta = delta;
+	matcher->_out_start = out_start;
+	matcher->_outputs = outputs;
+	matcher->_output_count = (total ? total : 1);
+}
+
+void
+_cstr_multimatcher_build_teddy
+(cstr_multimatcher_t *matcher)
+{
+	matcher->_teddy = (matcher->_count <= CSTR_TEDDY_MAX_PATTERNS);
+	matcher->_teddy_len = (matcher->_min_len < CSTR_TEDDY_FINGERPRINT) ? matcher->_min_len : CSTR_TEDDY_FINGERPRINT;
+
+	memset(matcher->_teddy_low, 0, sizeof(matcher->_teddy_low));
+	memset(matcher->_teddy_high, 0, sizeof(matcher->_teddy_high));
+
+	if (!matcher->_teddy)
+		return;
+
+	for (size_t p = 0; p < matcher->_count; ++p) {
+		const unsigned char *pattern = (const unsigned char *)matcher->_text + matcher->_offsets[p];
+		uint8_t bucket = (uint8_t)(1u << (p % CSTR_TEDDY_BUCKETS));
+
+		for (size_t k = 0; k < matcher->_teddy_len; ++k) {
+			matcher->_teddy_low[k][pattern[k] & 0x0F] |= bucket;
+			matcher->_teddy_high[k][pattern[k] >> 4] |= bucket;
+		}
+	}
+}
+
+bool
+_cstr_multimatcher_better
+(const cstr_multimatcher_t *matcher, size_t start, size_t id, size_t best, size_t best_id)
+{
+	if (best == CSTR_NPOS || start < best)
+		return true;
+
+	if (start > best)
+		return false;
+
+	if (matcher->_lens[id] != matcher->_lens[best_id])
+		return (matcher->_lens[id] > matcher->_lens[best_id]);
+
+	return (id < best_id);
+}
+
+size_t
+_cstr_multimatcher_scan
+(const cstr_multimatcher_t *matcher, const char *haystack, size_t haystack_len, size_t *id)
+{
+	const uint32_t *delta = matcher->_delta;
+	const uint32_t *out_start = matcher->_out_start;
+	size_t classes = matcher->_classes;
+	size_t best = CSTR_NPOS, best_id = 0;
+	uint32_t state = 0;
+
+	cstr_charset_fn_t skip = matcher->_skip ? _cstr_charset_first_kernel() : NULL;
+
+	for (size_t i = 0; i < haystack_len; ++i) {
+		if (state == 0) {
+			if (best != CSTR_NPOS)
+				break;
+
+			if (matcher->_skip) {
+				i = skip(&matcher->_first, haystack, i, haystack_len, true);
+				if (i == CSTR_NPOS)
+					break;
+			}
+		}
+
+		state = delta[state * classes + matcher->_class_of[(unsigned char)haystack[i]]];
+
+		for (uint32_t o = out_start[state]; o < out_start[state + 1]; ++o) {
+			size_t p = matcher->_outputs[o];
+			size_t start = i + 1 - matcher->_lens[p];
+
+			if (_cstr_multimatcher_better(matcher, start, p, best, best_id)) {
+				best = start;
+				best_id = p;
+			}
+		}
+
+		if ((best != CSTR_NPOS) && (i + 1 >= best + matcher->_max_len))
+			break;
+	}
+
+	if ((best != CSTR_NPOS) && id)
+		*id = best_id;
+
+	return best;
+}
+
+bool
+_cstr_teddy_verify
+(const cstr_multimatcher_t *matcher, const char *haystack, size_t haystack_len, size_t pos, unsigned bits, size_t *id)
+{
+	size_t best = CSTR_NPOS, best_id = 0;
+
+	while (bits) {
+		size_t bucket = (size_t)__builtin_ctz(bits);
+		bits &= bits - 1;
+
+		for (size_t p = bucket; p < matcher->_count; p += CSTR_TEDDY_BUCKETS) {
+			size_t len = matcher->_lens[p];
+			if ((len > haystack_len - pos) || (memcmp(haystack + pos, matcher->_text + matcher->_offsets[p], len) != 0))
+				continue;
+
+			if (_cstr_multimatcher_better(matcher, pos, p, best, best_id)) {
+				best = pos;
+				best_id = p;
+			}
+		}
+	}
+
+	if (best == CSTR_NPOS)
+		return false;
+
+	*id = best_id;
+	return true;
+}
+
+size_t
+_cstr_teddy_scalar
+(const cstr_multimatcher_t *matcher, const char *haystack, size_t haystack_len, size_t start, size_t *id)
+{
+	size_t fingerprint = matcher->_teddy_len;
+
+	for (size_t i = start; i + fingerprint <= haystack_len; ++i) {
+		unsigned bits = 0xFF;
+
+		for (size_t k = 0; (k < fingerprint) && bits; ++k) {
+			unsigned char byte = (unsigned char)haystack[i + k];
+			bits &= matcher->_teddy_low[k][byte & 0x0F] & matcher->_teddy_high[k][byte >> 4];
+		}
+
+		if (bits && _cstr_teddy_verify(matcher, haystack, haystack_len, i, bits, id))
+			return i;
+	}
+
+	return CSTR_NPOS;
+}
+
+#if	defined(CSTR_HAS_SSE2)
+
+__attribute__((target("ssse3")))
+size_t
+_cstr_teddy_ssse3
+(const cstr_multimatcher_t *matcher, const char *haystack, size_t haystack_len, size_t *id)
+{
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+	const __m128i zero = _mm_setzero_si128();
+	size_t fingerprint = matcher->_teddy_len;
+
+	size_t i = 0;
+	for (; i + 16 + fingerprint - 1 <= haystack_len; i += 16) {
+		__m128i result = _mm_set1_epi8(-1);
+
+		for (size_t k = 0; k < fingerprint; ++k) {
+			__m128i input = _mm_loadu_si128((const __m128i *)(haystack + i + k));
+			__m128i low = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)matcher->_teddy_low[k]), _mm_and_si128(input, nibble));
+			__m128i high = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)matcher->_teddy_high[k]), _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+			result = _mm_and_si128(result, _mm_and_si128(low, high));
+		}
+
+		unsigned mask = ~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(result, zero)) & 0xFFFFu;
+		if (!mask)
+			continue;
+
+		uint8_t buckets[16];
+		_mm_storeu_si128((__m128i *)buckets, result);
+
+		while (mask) {
+			size_t j = (size_t)__builtin_ctz(mask);
+			if (_cstr_teddy_verify(matcher, haystack, haystack_len, i + j, buckets[j], id))
+				return (i + j);
+
+			mask &= mask - 1;
+		}
+	}
+
+	return _cstr_teddy_scalar(matcher, haystack, haystack_len, i, id);
+}
+
+__attribute__((target("avx2")))
+size_t
+_cstr_teddy_avx2
+(const cstr_multimatcher_t *matcher, const char *haystack, size_t haystack_len, size_t *id)
+{
+	const __m256i nibble = _mm256_set1_epi8(0x0F);
+	const __m256i zero = _mm256_setzero_si256();
+	size_t fingerprint = matcher->_teddy_len;
+
+	__m256i low_tables[CSTR_TEDDY_FINGERPRINT];
+	__m256i high_tables[CSTR_TEDDY_FINGERPRINT];
+	for (size_t k = 0; k < fingerprint; ++k) {
+		low_tables[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)matcher->_teddy_low[k]));
+		high_tables[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)matcher->_teddy_high[k]));
+	}
+
+	size_t i = 0;
+	for (; i + 32 + fingerprint - 1 <= haystack_len; i += 32) {
+		__m256i result = _mm256_set1_epi8(-1);
+
+		for (size_t k = 0; k < fingerprint; ++k) {
+			__m256i input = _mm256_loadu_si256((const __m256i *)(haystack + i + k));
+			__m256i low = _mm256_shuffle_epi8(low_tables[k], _mm256_and_si256(input, nibble));
+			__m256i high = _mm256_shuffle_epi8(high_tables[k], _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+			result = _mm256_and_si256(result, _mm256_and_si256(low, high));
+		}
+
+		unsigned mask = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(result, zero));
+		if (!mask)
+			continue;
+
+		uint8_t buckets[32];
+		_mm256_storeu_si256((__m256i *)buckets, result);
+
+		while (mask) {
+			size_t j = (size_t)__builtin_ctz(mask);
+			if (_cstr_teddy_verify(matcher, haystack, haystack_len, i + j, buckets[j], id))
+				return (i + j);
+
+			mask &= mask - 1;
+		}
+	}
+
+	return _cstr_teddy_scalar(matcher, haystack, haystack_len, i, id);
+}
+
+#endif
+
+typedef size_t (*cstr_teddy_fn_t)(const cstr_multimatcher_t *, const char *, size_t, size_t *);
+
+cstr_teddy_fn_t
+_cstr_teddy_resolve
+(void)
+{
+#if	defined(CSTR_HAS_SSE2)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return _cstr_teddy_avx2;
+
+	if (__builtin_cpu_supports("ssse3"))
+		return _cstr_teddy_ssse3;
+#endif
+
+	return _cstr_multimatcher_scan;
+}
+
+size_t
+_cstr_multimatcher_find
+(const cstr_multimatcher_t *matcher, const char *haystack, size_t haystack_len, size_t *id)
+{
+	static _Atomic(cstr_teddy_fn_t) cached = NULL;
+
+	if (matcher->_count == 0)
+		return CSTR_NPOS;
+
+	if (matcher->_teddy) {
+		cstr_teddy_fn_t teddy = atomic_load_explicit(&cached, memory_order_acquire);
+		if (!teddy) {
+			teddy = _cstr_teddy_resolve();
+			atomic_store_explicit(&cached, teddy, memory_order_release);
+		}
+
+		return teddy(matcher, haystack, haystack_len, id);
+	}
+
+	return _cstr_multimatcher_scan(matcher, haystack, haystack_len, id);
+}
+
+int
+_cstr_compare_mem
+(const char *left, size_t left_len, const char *right, size_t right_len)
+{
+	size_t common = (left_len < right_len) ? left_len : right_len;
+
+	int res = memcmp(left, right, common);
+	if (res != 0)
+		return res;
+
+	return ((left_len < right_len) ? -1 : ((left_len > right_len) ? 1 : 0));
+}
+
+void
+cstr_charset_init
+(cstr_charset_t *charset, const char *set, size_t len)
+{
+	assert(charset && "charset argument must be valid!");
+	assert((set || (len == 0)) && "set argument must be valid!");
+
+	memset(charset, 0, sizeof(cstr_charset_t));
+
+	for (size_t i = 0; i < len; ++i)
+		cstr_charset_add(charset, set[i]);
+}
+
+void
+cstr_charset_add
+(cstr_charset_t *charset, char c)
+{
+	unsigned char byte = (unsigned char)c;
+
+	charset->_bitmap[byte >> 3] |= (uint8_t)(1u << (byte & 7));
+
+	if (byte < 0x80)
+		charset->_low[byte & 0x0F] |= (uint8_t)(1u << (byte >> 4));
+	else
+		charset->_high[byte & 0x0F] |= (uint8_t)(1u << ((byte >> 4) - 8));
+}
+
+bool
+cstr_charset_contains
+(const cstr_charset_t *charset, char c)
+{
+	return _cstr_charset_test(charset, (unsigned char)c);
+}
+
+cstr_searcher_t *
+cstr_searcher_new
+(const char *needle, size_t len)
+{
+	assert((needle || (len == 0)) && "needle argument must be valid!");
+
+	const cstr_allocator_t *allocator = _cstr_global_allocator;
+
+	cstr_searcher_t *searcher = allocator->alloc(allocator->context, sizeof(cstr_searcher_t) + len + 1);
+	assert(searcher && "failed to allocate searcher!");
+
+	searcher->_allocator = allocator;
+	searcher->_len = len;
+
+	if (len > 0)
+		memcpy(searcher->_needle, needle, len);
+	searcher->_needle[len] = '\0';
+
+	_cstr_searcher_prepare(searcher);
+	return searcher;
+}
+
+void
+cstr_searcher_destroy
+(cstr_searcher_t *searcher)
+{
+	if (!searcher)
+		return;
+
+	const cstr_allocator_t *allocator = searcher->_allocator;
+	allocator->free(allocator->context, searcher, sizeof(cstr_searcher_t) + searcher->_len + 1);
+}
+
+size_t
+cstr_find_with
+(const cstr_searcher_t *searcher, string_t string, size_t pos)
+{
+	assert(searcher && "searcher argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	size_t offset = _cstr_searcher_search(searcher, string + pos, _cstr_get_size(string) - pos);
+
+	return ((offset == CSTR_NPOS) ? CSTR_NPOS : (pos + offset));
+}
+
+size_t
+cstr_rfind_with
+(const cstr_searcher_t *searcher, string_t string, size_t pos)
+{
+	assert(searcher && "searcher argument must be valid!");
+
+	size_t size = cstr_size(string);
+	size_t len = searcher->_len;
+	if (len > size)
+		return CSTR_NPOS;
+
+	size_t start = ((pos < size - len) ? pos : (size - len));
+	return _cstr_searcher_rsearch(searcher, string, start + len);
+}
+
+cstr_multimatcher_t *
+cstr_multimatcher_new
+(const char *const *patterns, const size_t *lens, size_t count)
+{
+	assert((patterns || (count == 0)) && "patterns argument must be valid!");
+
+	const cstr_allocator_t *allocator = _cstr_global_allocator;
+
+	cstr_multimatcher_t *matcher = allocator->alloc(allocator->context, sizeof(cstr_multimatcher_t));
+	assert(matcher && "failed to allocate multimatcher!");
+
+	matcher->_allocator = allocator;
+	matcher->_count = count;
+	matcher->_min_len = SIZE_MAX;
+	matcher->_max_len = 0;
+	matcher->_text_size = 0;
+
+	size_t list_size = (count ? count : 1) * sizeof(size_t);
+	matcher->_lens = _cstr_multimatcher_alloc(matcher, list_size);
+	matcher->_offsets = _cstr_multimatcher_alloc(matcher, list_size);
+
+	for (size_t p = 0; p < count; ++p) {
+		assert(patterns[p] && "pattern must be valid!");
+
+		size_t len = (lens ? lens[p] : strlen(patterns[p]));
+		assert((len > 0) && "pattern must not be empty!");
+
+		matcher->_lens[p] = len;
+		matcher->_offsets[p] = matcher->_text_size;
+		matcher->_text_size += len;
+
+		if (len < matcher->_min_len)
+			matcher->_min_len = len;
+		if (len > matcher->_max_len)
+			matcher->_max_len = len;
+	}
+
+	matcher->_text = _cstr_multimatcher_alloc(matcher, matcher->_text_size + 1);
+	cstr_charset_init(&matcher->_first, NULL, 0);
+
+	for (size_t p = 0; p < count; ++p) {
+		memcpy(matcher->_text + matcher->_offsets[p], patterns[p], matcher->_lens[p]);
+		cstr_charset_add(&matcher->_first, patterns[p][0]);
+	}
+	matcher->_text[matcher->_text_size] = '\0';
+
+	size_t first_bytes = 0;
+	for (size_t c = 0; c < 256; ++c)
+		first_bytes += _cstr_charset_test(&matcher->_first, (unsigned char)c);
+	matcher->_skip = (first_bytes <= CSTR_MULTIMATCHER_SKIP_MAX);
+
+	_cstr_multimatcher_build_dfa(matcher);
+	_cstr_multimatcher_build_teddy(matcher);
+
+	return matcher;
+}
+
+void
+cstr_multimatcher_destroy
+(cstr_multimatcher_t *matcher)
+{
+	if (!matcher)
+		return;
+
+	size_t list_size = (matcher->_count ? matcher->_count : 1) * sizeof(size_t);
+
+	_cstr_multimatcher_free(matcher, matcher->_lens, list_size);
+	_cstr_multimatcher_free(matcher, matcher->_offsets, list_size);
+	_cstr_multimatcher_free(matcher, matcher->_text, matcher->_text_size + 1);
+	_cstr_multimatcher_free(matcher, matcher->_delta, matcher->_states * matcher->_classes * sizeof(uint32_t));
+	_cstr_multimatcher_free(matcher, matcher->_out_start, (matcher->_states + 1) * sizeof(uint32_t));
+	_cstr_multimatcher_free(matcher, matcher->_outputs, matcher->_output_count * sizeof(uint32_t));
+
+	const cstr_allocator_t *allocator = matcher->_allocator;
+	allocator->free(allocator->context, matcher, sizeof(cstr_multimatcher_t));
+}
+
+size_t
+cstr_multimatcher_find
+(const cstr_multimatcher_t *matcher, string_t string, size_t pos, size_t *id)
+{
+	assert(matcher && "matcher argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	size_t offset = _cstr_multimatcher_find(matcher, string + pos, _cstr_get_size(string) - pos, id);
+
+	return ((offset == CSTR_NPOS) ? CSTR_NPOS : (pos + offset));
+}
+
+size_t
+cstr_multimatcher_find_all
+(const cstr_multimatcher_t *matcher, string_t string, size_t pos, cstr_match_fn_t callback, void *context)
+{
+	assert(matcher && "matcher argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	const uint32_t *delta = matcher->_delta;
+	const uint32_t *out_start = matcher->_out_start;
+	size_t classes = matcher->_classes;
+	size_t size = _cstr_get_size(string);
+	size_t matches = 0;
+	uint32_t state = 0;
+
+	if (matcher->_count == 0)
+		return 0;
+
+	cstr_charset_fn_t skip = matcher->_skip ? _cstr_charset_first_kernel() : NULL;
+
+	for (size_t i = pos; i < size; ++i) {
+		if ((state == 0) && matcher->_skip) {
+			i = skip(&matcher->_first, string, i, size, true);
+			if (i == CSTR_NPOS)
+				break;
+		}
+
+		state = delta[state * classes + matcher->_class_of[(unsigned char)string[i]]];
+
+		for (uint32_t o = out_start[state]; o < out_start[state + 1]; ++o) {
+			size_t p = matcher->_outputs[o];
+			++matches;
+
+			if (callback && !callback(context, p, i + 1 - matcher->_lens[p]))
+				return matches;
+		}
+	}
+
+	return matches;
+}
+
+bool
+cstr_multimatcher_matches
+(const cstr_multimatcher_t *matcher, string_t string, size_t pos)
+{
+	size_t id;
+
+	return (cstr_multimatcher_find(matcher, string, pos, &id) != CSTR_NPOS);
+}
+
+size_t
+cstr_find
+(string_t string, const char *find_str, size_t pos)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	return _cstr_find_at(string, pos, find_str, strlen(find_str));
+}
+
+size_t
+cstr_find_n
+(string_t string, const char *find_str, size_t pos, size_t n)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	return _cstr_find_at(string, pos, find_str, n);
+}
+
+size_t
+cstr_find_string
+(string_t string, const string_t find_str, size_t pos)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	return _cstr_find_at(string, pos, find_str, _cstr_get_size(find_str));
+}
+
+size_t
+cstr_find_char
+(string_t string, char c, size_t pos)
+{
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	return _cstr_find_at(string, pos, &c, 1);
+}
+
+size_t
+cstr_rfind
+(string_t string, const char *find_str, size_t pos)
+{
+	assert(find_str && "find_str argument must be valid!");
+
+	return _cstr_rfind_at(string, pos, find_str, strlen(find_str));
+}
+
+size_t
+cstr_rfind_n
+(string_t string, const char *find_str, size_t pos, size_t n)
+{
+	assert(find_str && "find_str argument must be valid!");
+
+	return _cstr_rfind_at(string, pos, find_str, n);
+}
+
+size_t
+cstr_rfind_string
+(string_t string, const string_t find_str, size_t pos)
+{
+	assert(find_str && "find_str argument must be valid!");
+
+	return _cstr_rfind_at(string, pos, find_str, _cstr_get_size(find_str));
+}
+
+size_t
+cstr_find_all
+(string_t string, const char *find_str, size_t *positions, size_t cap)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((positions || (cap == 0)) && "positions argument must be valid!");
+
+	return _cstr_find_all_at(string, find_str, strlen(find_str), positions, cap, CSTR_MATCH_DISJOINT);
+}
+
+size_t
+cstr_find_all_n
+(string_t string, const char *find_str, size_t n, size_t *positions, size_t cap, cstr_match_mode_t mode)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((positions || (cap == 0)) && "positions argument must be valid!");
+
+	return _cstr_find_all_at(string, find_str, n, positions, cap, mode);
+}
+
+size_t
+cstr_count
+(string_t string, const char *find_str)
+{
+	assert(find_str && "find_str argument must be valid!");
+
+	return cstr_count_n(string, find_str, strlen(find_str), CSTR_MATCH_DISJOINT);
+}
+
+size_t
+cstr_count_n
+(string_t string, const char *find_str, size_t n, cstr_match_mode_t mode)
+{
+	assert(find_str && "find_str argument must be valid!");
+
+	if (n == 1)
+		return _cstr_count_byte(string, _cstr_get_size(string), find_str[0]);
+
+	return _cstr_find_all_at(string, find_str, n, NULL, 0, mode);
+}
+
+size_t
+cstr_count_char
+(string_t string, char c)
+{
+	return _cstr_count_byte(string, cstr_size(string), c);
+}
+
+void
+cstr_match_iter_init
+(cstr_match_iter_t *iter, string_t string, const char *find_str, size_t n, cstr_match_mode_t mode)
+{
+	assert(iter && "iter argument must be valid!");
+	assert(find_str && "find_str argument must be valid!");
+
+	iter->_string = string;
+	iter->_needle = find_str;
+	iter->_len = n;
+	iter->_step = ((mode == CSTR_MATCH_OVERLAP) || (n == 0)) ? 1 : n;
+	iter->_pos = 0;
+}
+
+size_t
+cstr_match_next
+(cstr_match_iter_t *iter)
+{
+	assert(iter && "iter argument must be valid!");
+
+	if (iter->_pos > _cstr_get_size(iter->_string))
+		return CSTR_NPOS;
+
+	size_t found = _cstr_find_at(iter->_string, iter->_pos, iter->_needle, iter->_len);
+	iter->_pos = ((found == CSTR_NPOS) ? CSTR_NPOS : (found + iter->_step));
+
+	return found;
+}
+
+string_t
+_cstr_replace_all_shrink
+(string_t string, size_t first, const char *find_str, size_t find_len, const char *replace_str, size_t replace_len)
+{
+	size_t old_size = _cstr_get_size(string);
+	size_t read = 0, write = 0;
+
+	size_t found = first;
+	while (found != CSTR_NPOS) {
+		memmove(string + write, string + read, found - read);
+		write += found - read;
+
+		memcpy(string + write, replace_str, replace_len);
+		write += replace_len;
+
+		read = found + find_len;
+		found = _cstr_find_at(string, read, find_str, find_len);
+	}
+
+	memmove(string + write, string + read, old_size - read);
+	write += old_size - read;
+
+	_cstr_set_size(string, write);
+	return ((write < old_size) ? _cstr_auto_shrink(string) : string);
+}
+
+string_t
+_cstr_replace_all_grow
+(string_t string, const char *find_str, size_t find_len, const char *replace_str, size_t replace_len)
+{
+	size_t stack_positions[CSTR_REPLACE_STACK_POSITIONS];
+	size_t *positions = stack_positions;
+
+	size_t count = _cstr_find_all_at(string, find_str, find_len, positions, CSTR_REPLACE_STACK_POSITIONS, CSTR_MATCH_DISJOINT);
+	if (count > CSTR_REPLACE_STACK_POSITIONS) {
+		positions = _cstr_temp_alloc(count * sizeof(size_t));
+		_cstr_find_all_at(string, find_str, find_len, positions, count, CSTR_MATCH_DISJOINT);
+	}
+
+	size_t old_size = _cstr_get_size(string);
+	size_t new_size = old_size + count * (replace_len - find_len);
+
+	if (new_size > _cstr_get_capacity(string))
+		string = _cstr_expand(string, new_size);
+
+	size_t read = old_size, write = new_size;
+	for (size_t i = count; i > 0; --i) {
+		size_t tail = read - (positions[i - 1] + find_len);
+
+		write -= tail;
+		memmove(string + write, string + positions[i - 1] + find_len, tail);
+
+		write -= replace_len;
+		memcpy(string + write, replace_str, replace_len);
+
+		read = positions[i - 1];
+	}
+
+	if (positions != stack_positions)
+		_cstr_temp_free(positions, count * sizeof(size_t));
+
+	_cstr_set_size(string, new_size);
+	return string;
+}
+
+string_t
+cstr_replace_all
+(string_t string, const char *find_str, const char *replace_str)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert(replace_str && "replace_str argument must be valid!");
+
+	return cstr_replace_all_n(string, find_str, strlen(find_str), replace_str, strlen(replace_str));
+}
+
+string_t
+cstr_replace_all_n
+(string_t string, const char *find_str, size_t find_len, const char *replace_str, size_t replace_len)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert(replace_str && "replace_str argument must be valid!");
+	assert((find_len > 0) && "find_str must not be empty!");
+
+	size_t first = _cstr_find_at(string, 0, find_str, find_len);
+	if (first == CSTR_NPOS)
+		return string;
+
+	char *copy = NULL;
+	size_t copy_len = find_len + replace_len;
+
+	if (_cstr_points_into(string, find_str) || ((replace_len > 0) && _cstr_points_into(string, replace_str))) {
+		copy = _cstr_temp_alloc(copy_len);
+		memcpy(copy, find_str, find_len);
+		memcpy(copy + find_len, replace_str, replace_len);
+
+		find_str = copy;
+		replace_str = copy + find_len;
+	}
+
+	string = _cstr_mutable(string);
+
+	if (replace_len <= find_len)
+		string = _cstr_replace_all_shrink(string, first, find_str, find_len, replace_str, replace_len);
+	else
+		string = _cstr_replace_all_grow(string, find_str, find_len, replace_str, replace_len);
+
+	if (copy)
+		_cstr_temp_free(copy, copy_len);
+
+	return string;
+}
+
+string_t
+cstr_replace_all_string
+(string_t string, const string_t find_str, const string_t replace_str)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert(replace_str && "replace_str argument must be valid!");
+
+	return cstr_replace_all_n(string, find_str, _cstr_get_size(find_str), replace_str, _cstr_get_size(replace_str));
+}
+
+size_t
+cstr_rfind_char
+(string_t string, char c, size_t pos)
+{
+	return _cstr_rfind_at(string, pos, &c, 1);
+}
+
+size_t
+cstr_find_first_of
+(string_t string, const char *find_str, size_t pos)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, find_str, strlen(find_str));
+
+	return _cstr_charset_first(&charset, string, pos, true);
+}
+
+size_t
+cstr_find_first_of_n
+(string_t string, const char *find_str, size_t pos, size_t n)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, find_str, n);
+
+	return _cstr_charset_first(&charset, string, pos, true);
+}
+
+size_t
+cstr_find_first_of_string
+(string_t string, const string_t find_str, size_t pos)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, find_str, _cstr_get_size(find_str));
+
+	return _cstr_charset_first(&charset, string, pos, true);
+}
+
+size_t
+cstr_find_first_of_charset
+(string_t string, const cstr_charset_t *charset, size_t pos)
+{
+	assert(charset && "charset argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	return _cstr_charset_first(charset, string, pos, true);
+}
+
+size_t
+cstr_find_first_of_char
+(string_t string, char c, size_t pos)
+{
+	return cstr_find_char(string, c, pos);
+}
+
+size_t
+cstr_find_last_of
+(string_t string, const char *find_str, size_t pos)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, find_str, strlen(find_str));
+
+	return _cstr_charset_last(&charset, string, pos, true);
+}
+
+size_t
+cstr_find_last_of_n
+(string_t string, const char *find_str, size_t pos, size_t n)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, find_str, n);
+
+	return _cstr_charset_last(&charset, string, pos, true);
+}
+
+size_t
+cstr_find_last_of_string
+(string_t string, const string_t find_str, size_t pos)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, find_str, _cstr_get_size(find_str));
+
+	return _cstr_charset_last(&charset, string, pos, true);
+}
+
+size_t
+cstr_find_last_of_charset
+(string_t string, const cstr_charset_t *charset, size_t pos)
+{
+	assert(charset && "charset argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	return _cstr_charset_last(charset, string, pos, true);
+}
+
+size_t
+cstr_find_last_of_char
+(string_t string, char c, size_t pos)
+{
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	const char *found = _cstr_memrchr(string + pos, c, _cstr_get_size(string) - pos);
+	return (found ? (size_t)(found - string) : CSTR_NPOS);
+}
+
+size_t
+cstr_find_first_not_of
+(string_t string, const char *find_str, size_t pos)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, find_str, strlen(find_str));
+
+	return _cstr_charset_first(&charset, string, pos, false);
+}
+
+size_t
+cstr_find_first_not_of_n
+(string_t string, const char *find_str, size_t pos, size_t n)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, find_str, n);
+
+	return _cstr_charset_first(&charset, string, pos, false);
+}
+
+size_t
+cstr_find_first_not_of_string
+(string_t string, const string_t find_str, size_t pos)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, find_str, _cstr_get_size(find_str));
+
+	return _cstr_charset_first(&charset, string, pos, false);
+}
+
+size_t
+cstr_find_first_not_of_charset
+(string_t string, const cstr_charset_t *charset, size_t pos)
+{
+	assert(charset && "charset argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	return _cstr_charset_first(charset, string, pos, false);
+}
+
+size_t
+cstr_find_first_not_of_char
+(string_t string, char c, size_t pos)
+{
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, &c, 1);
+
+	return _cstr_charset_first(&charset, string, pos, false);
+}
+
+size_t
+cstr_find_last_not_of
+(string_t string, const char *find_str, size_t pos)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, find_str, strlen(find_str));
+
+	return _cstr_charset_last(&charset, string, pos, false);
+}
+
+size_t
+cstr_find_last_not_of_n
+(string_t string, const char *find_str, size_t pos, size_t n)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, find_str, n);
+
+	return _cstr_charset_last(&charset, string, pos, false);
+}
+
+size_t
+cstr_find_last_not_of_string
+(string_t string, const string_t find_str, size_t pos)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, find_str, _cstr_get_size(find_str));
+
+	return _cstr_charset_last(&charset, string, pos, false);
+}
+
+size_t
+cstr_find_last_not_of_charset
+(string_t string, const cstr_charset_t *charset, size_t pos)
+{
+	assert(charset && "charset argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	return _cstr_charset_last(charset, string, pos, false);
+}
+
+size_t
+cstr_find_last_not_of_char
+(string_t string, char c, size_t pos)
+{
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	cstr_charset_t charset;
+	cstr_charset_init(&charset, &c, 1);
+
+	return _cstr_charset_last(&charset, string, pos, false);
+}
+
+string_t
+cstr_substr
+(string_t string, size_t pos, size_t len)
+{
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	size_t length = cstr_size(string) - pos;
+	size_t actual_len = ((len > length) ? length : len);
+
+	string_t substr = _cstr_alloc((actual_len > 0) ? actual_len : CSTR_DEFAULT_CAPACITY, _cstr_allocator_of(string));
+	memcpy(substr, string + pos, actual_len);
+	_cstr_set_size(substr, actual_len);
+
+	return substr;
+}
+
+int
+cstr_compare
+(string_t string, const char *compare_str)
+{	
+	assert(compare_str && "compare_str argument must be valid!");
+
+	return strcmp(cstr_data(string), compare_str);
+}
+
+int
+cstr_compare_ext
+(string_t string, size_t pos, size_t len, const char *compare_str)
+{
+	assert(compare_str && "compare_str argument must be valid!");
+
+	return strncmp(cstr_data(string) + pos, compare_str, len);
+}
+
+int
+cstr_compare_n
+(string_t string, const char *compare_str, size_t n)
+{
+	assert(compare_str && "compare_str argument must be valid!");
+
+	return _cstr_compare_mem(string, _cstr_get_size(string), compare_str, n);
+}
+
+int
+cstr_compare_n_ext
+(string_t string, size_t pos, size_t len, const char *compare_str, size_t n)
+{
+	assert(compare_str && "compare_str argument must be valid!");
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	size_t length = _cstr_get_size(string) - pos;
+	size_t left_len = (len < length) ? len : length;
+	size_t right_len = (len < n) ? len : n;
+
+	return _cstr_compare_mem(string + pos, left_len, compare_str, right_len);
+}
+
+int
+cstr_compare_string
+(string_t string, const string_t compare_str)
+{
+	return cstr_compare(string, cstr_data(compare_str));
+}
+
+int
+cstr_compare_string_ext
+(string_t string, size_t pos, size_t len, const string_t compare_str)
+{
+	return cstr_compare_ext(string, pos, len, cstr_data(compare_str));
+}
+
+int
+cstr_compare_substring
+(string_t string, const string_t compare_str, size_t subpos, size_t sublen)
+{
+	assert(compare_str && "compare_str argument must be valid!");
+
+	size_t length = cstr_length(compare_str);
+	if (subpos < length) {
+		size_t actual_sublen = ((sublen > (length - subpos)) ? (length - subpos) : sublen);
+		return cstr_compare_n(string, cstr_data(compare_str) + subpos, actual_sublen);
+	}
+
+	return cstr_max_size(string);
+}
+
+int
+cstr_compare_substring_ext
+(string_t string, size_t pos, size_t len, const string_t compare_str, size_t subpos, size_t sublen)
+{
+	assert(compare_str && "compare_str argument must be valid!");
+
+	size_t length = cstr_length(compare_str);
+	if (subpos < length) {
+		size_t actual_sublen = ((sublen > (length - subpos)) ? (length - subpos) : sublen);
+		return cstr_compare_n_ext(string, pos, len, cstr_data(compare_str) + subpos, actual_sublen);
+	}
+
+	return cstr_max_size(string);
+}
+
+cstr_view_t
+cstr_view
+(string_t string, size_t pos, size_t len)
+{
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	size_t length = _cstr_get_size(string) - pos;
+
+	cstr_view_t view = { string + pos, ((len > length) ? length : len) };
+	return view;
+}
+
+cstr_view_t
+cstr_view_of
+(const char *ptr, size_t len)
+{
+	assert((ptr || (len == 0)) && "ptr argument must be valid!");
+
+	cstr_view_t view = { (ptr ? ptr : ""), len };
+	return view;
+}
+
+cstr_view_t
+cstr_view_sub
+(cstr_view_t view, size_t pos, size_t len)
+{
+	assert((pos <= view.len) && "'pos' argument is out of range!");
+
+	size_t length = view.len - pos;
+
+	cstr_view_t sub = { view.ptr + pos, ((len > length) ? length : len) };
+	return sub;
+}
+
+string_t
+cstr_new_view
+(cstr_view_t view)
+{
+	string_t string = _cstr_alloc(view.len, _cstr_global_allocator);
+	if (view.len > 0)
+		memcpy(string, view.ptr, view.len);
+
+	_cstr_set_size(string, view.len);
+	return string;
+}
+
+size_t
+cstr_view_find
+(cstr_view_t view, cstr_view_t find_view, size_t pos)
+{
+	assert((pos <= view.len) && "'pos' argument is out of range!");
+
+	size_t offset = _cstr_search(view.ptr + pos, view.len - pos, find_view.ptr, find_view.len);
+
+	return ((offset == CSTR_NPOS) ? CSTR_NPOS : (pos + offset));
+}
+
+size_t
+cstr_view_rfind
+(cstr_view_t view, cstr_view_t find_view, size_t pos)
+{
+	if (find_view.len > view.len)
+		return CSTR_NPOS;
+
+	size_t start = ((pos < view.len - find_view.len) ? pos : (view.len - find_view.len));
+	return _cstr_rsearch(view.ptr, start + find_view.len, find_view.ptr, find_view.len);
+}
+
+int
+cstr_view_compare
+(cstr_view_t left, cstr_view_t right)
+{
+	return _cstr_compare_mem(left.ptr, left.len, right.ptr, right.len);
+}
+
+size_t
+cstr_find_view
+(string_t string, cstr_view_t find_view, size_t pos)
+{
+	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+
+	return _cstr_find_at(string, pos, find_view.ptr, find_view.len);
+}
+
+size_t
+cstr_rfind_view
+(string_t string, cstr_view_t find_view, size_t pos)
+{
+	return _cstr_rfind_at(string, pos, find_view.ptr, find_view.len);
+}
+
+size_t
+cstr_find_first_of_view
+(string_t string, cstr_view_t find_view, size_t pos)
+{
+	return cstr_find_first_of_n(string, find_view.ptr, pos, find_view.len);
+}
+
+size_t
+cstr_find_last_of_view
+(string_t string, cstr_view_t find_view, size_t pos)
+{
+	return cstr_find_last_of_n(string, find_view.ptr, pos, find_view.len);
+}
+
+size_t
+cstr_find_first_not_of_view
+(string_t string, cstr_view_t find_view, size_t pos)
+{
+	return cstr_find_first_not_of_n(string, find_view.ptr, pos, find_view.len);
+}
+
+size_t
+cstr_find_last_not_of_view
+(string_t string, cstr_view_t find_view, size_t pos)
+{
+	return cstr_find_last_not_of_n(string, find_view.ptr, pos, find_view.len);
+}
+
+int
+cstr_compare_view
+(string_t string, cstr_view_t compare_view)
+{
+	return _cstr_compare_mem(string, cstr_size(string), compare_view.ptr, compare_view.len);
+}
+
+bool
+_cstr_view_aliases
+(string_t string, cstr_view_t view)
+{
+	uintptr_t begin = (uintptr_t)string;
+	uintptr_t end = begin + _cstr_get_capacity(string) + 1;
+	uintptr_t ptr = (uintptr_t)view.ptr;
+
+	return (view.len > 0) && (ptr >= begin) && (ptr < end);
+}
+
+string_t
+cstr_append_view
+(string_t string, cstr_view_t append_view)
+{
+	return cstr_insert_view(string, _cstr_get_size(string), append_view);
+}
+
+string_t
+cstr_insert_view
+(string_t string, size_t pos, cstr_view_t insert_view)
+{
+	return cstr_replace_view(string, pos, 0, insert_view);
+}
+
+string_t
+cstr_replace_view
+(string_t string, size_t pos, size_t len, cstr_view_t replace_view)
+{
+	if (!_cstr_view_aliases(string, replace_view))
+		return cstr_replace_n(string, pos, len, replace_view.ptr, replace_view.len);
+
+	char *copy = _cstr_temp_alloc(replace_view.len);
+	memcpy(copy, replace_view.ptr, replace_view.len);
+
+	string = cstr_replace_n(string, pos, len, copy, replace_view.len);
+
+	_cstr_temp_free(copy, replace_view.len);
+	return string;
+}
+
+
+size_t
+cstr_size
+(string_t string)
+{
+	return _cstr_get_size(string);
+}
+
+size_t
+cstr_length
+(string_t string)
+{
+	return _cstr_get_size(string);
+}
+
+size_t
+cstr_max_size
+(string_t string)
+{
+	return SIZE_MAX;
+}
+
+size_t
+cstr_capacity
+(string_t string)
+{
+	return _cstr_get_capacity(string);
+}
+
+void *
+cstr_begin
+(string_t string)
+{
+	return string;
+}
+
+void *
+cstr_end
+(string_t string)
+{
+	return (string + (_cstr_get_size(string) - 1));
+}
+
+bool
+cstr_empty
+(string_t string)
+{
+	return (_cstr_get_size(string) == 0);
+}
+
+char
+cstr_at
+(string_t string, const size_t pos)
+{
+	assert(
+		(pos < _cstr_get_size(string)) &&
+		"attempted to access element at out of bound position!"
+	);
+
+	return (string[pos]);
+}
+
+char
+cstr_front
+(string_t string)
+{
+	return (*(char *)cstr_begin(string));
+}
+
+char
+cstr_back
+(string_t string)
+{
+	return (*(char *)cstr_end(string));
+}
+
+char *
+cstr_data
+(string_t string)
+{
+	return (char *)(cstr_begin(string));
+}
+
+struct cstr_rope_node_t
+{
+	atomic_size_t		_refs;
+	size_t				_length;
+	size_t				_height;
+	cstr_rope_node_t *	_left;
+	cstr_rope_node_t *	_right;
+	char				_text[];
+};
+
+struct cstr_rope_t
+{
+	const cstr_allocator_t *	_allocator;
+	cstr_rope_node_t *			_root;
+};
+
+size_t
+_cstr_rope_length
+(const cstr_rope_node_t *node)
+{
+	return (node ? node->_length : 0);
+}
+
+size_t
+_cstr_rope_height
+(const cstr_rope_node_t *node)
+{
+	return (node ? node->_height : 0);
+}
+
+bool
+_cstr_rope_is_leaf
+(const cstr_rope_node_t *node)
+{
+	return (node->_height == 1);
+}
+
+size_t
+_cstr_rope_node_size
+(const cstr_rope_node_t *node)
+{
+	return sizeof(cstr_rope_node_t) + (_cstr_rope_is_leaf(node) ? node->_length : 0);
+}
+
+cstr_rope_node_t *
+_cstr_rope_retain
+(cstr_rope_node_t *node)
+{
+	if (node)
+		atomic_fetch_add_explicit(&node->_refs, 1, memory_order_relaxed);
+
+	return node;
+}
+
+void
+_cstr_rope_release
+(const cstr_allocator_t *allocator, cstr_rope_node_t *node)
+{
+	while (node && (atomic_fetch_sub_explicit(&node->_refs, 1, memory_order_acq_rel) == 1)) {
+		cstr_rope_node_t *left = node->_left;
+		cstr_rope_node_t *right = node->_right;
+
+		allocator->free(allocator->context, node, _cstr_rope_node_size(node));
+
+		_cstr_rope_release(allocator, left);
+		node = right;
+	}
+}
+
+cstr_rope_node_t *
+_cstr_rope_leaf
+(const cstr_allocator_t *allocator, const char *text, size_t len)
+{
+	cstr_rope_node_t *node = allocator->alloc(allocator->context, sizeof(cstr_rope_node_t) + len);
+	assert(node && "failed to allocate rope node!");
+
+	atomic_init(&node->_refs, 1);
+	node->_length = len;
+	node->_height = 1;
+	node->_left = NULL;
+	node->_right = NULL;
+	memcpy(node->_text, text, len);
+
+	return node;
+}
+
+cstr_rope_node_t *
+_cstr_rope_inner
+(const cstr_allocator_t *allocator, cstr_rope_node_t *left, cstr_rope_node_t *right)
+{
+	cstr_rope_node_t *node = allocator->alloc(allocator->context, sizeof(cstr_rope_node_t));
+	assert(node && "failed to allocate rope node!");
+
+	size_t left_height = _cstr_rope_height(left);
+	size_t right_height = _cstr_rope_height(right);
+
+	atomic_init(&node->_refs, 1);
+	node->_length = _cstr_rope_length(left) + _cstr_rope_length(right);
+	node->_height = ((left_height > right_height) ? left_height : right_height) + 1;
+	node->_left = left;
+	node->_right = right;
+
+	return node;
+}
+
+void
+_cstr_rope_unpack
+(const cstr_allocator_t *allocator, cstr_rope_node_t *node, cstr_rope_node_t **left, cstr_rope_node_t **right)
+{
+	*left = _cstr_rope_retain(node->_left);
+	*right = _cstr_rope_retain(node->_right);
+
+	_cstr_rope_release(allocator, node);
+}
+
+cstr_rope_node_t *
+_cstr_rope_rotate_left
+(const cstr_allocator_t *allocator, cstr_rope_node_t *node)
+{
+	cstr_rope_node_t *a, *pivot, *b, *c;
+
+	_cstr_rope_unpack(allocator, node, &a, &pivot);
+	_cstr_rope_unpack(allocator, pivot, &b, &c);
+
+	return _cstr_rope_inner(allocator, _cstr_rope_inner(allocator, a, b), c);
+}
+
+cstr_rope_node_t *
+_cstr_rope_rotate_right
+(const cstr_allocator_t *allocator, cstr_rope_node_t *node)
+{
+	cstr_rope_node_t *pivot, *a, *b, *c;
+
+	_cstr_rope_unpack(allocator, node, &pivot, &c);
+	_cstr_rope_unpack(allocator, pivot, &a, &b);
+
+	return _cstr_rope_inner(allocator, a, _cstr_rope_inner(allocator, b, c));
+}
+
+cstr_rope_node_t *
+_cstr_rope_join
+(const cstr_allocator_t *allocator, cstr_rope_node_t *left, cstr_rope_node_t *right);
+
+cstr_rope_node_t *
+_cstr_rope_join_right
+(const cstr_allocator_t *allocator, cstr_rope_node_t *left, cstr_rope_node_t *right)
+{
+	cstr_rope_node_t *a, *c;
+	_cstr_rope_unpack(allocator, left, &a, &c);
+
+	cstr_rope_node_t *joined = _cstr_rope_join(allocator, c, right);
+	if (joined->_height > a->_height + 1) {
+		if (_cstr_rope_height(joined->_left) > _cstr_rope_height(joined->_right))
+			joined = _cstr_rope_rotate_right(allocator, joined);
+
+		return _cstr_rope_rotate_left(allocator, _cstr_rope_inner(allocator, a, joined));
+	}
+
+	return _cstr_rope_inner(allocator, a, joined);
+}
+
+cstr_rope_node_t *
+_cstr_rope_join_left
+(const cstr_allocator_t *allocator, cstr_rope_node_t *left, cstr_rope_node_t *right)
+{
+	cstr_rope_node_t *a, *c;
+	_cstr_rope_unpack(allocator, right, &a, &c);
+
+	cstr_rope_node_t *joined = _cstr_rope_join(allocator, left, a);
+	if (joined->_height > c->_height + 1) {
+		if (_cstr_rope_height(joined->_right) > _cstr_rope_height(joined->_left))
+			joined = _cstr_rope_rotate_left(allocator, joined);
+
+		return _cstr_rope_rotate_right(allocator, _cstr_rope_inner(allocator, joined, c));
+	}
+
+	return _cstr_rope_inner(allocator, joined, c);
+}
+
+cstr_rope_node_t *
+_cstr_rope_join
+(const cstr_allocator_t *allocator, cstr_rope_node_t *left, cstr_rope_node_t *right)
+{
+	if (!left || (left->_length == 0)) {
+		_cstr_rope_release(allocator, left);
+		return right;
+	}
+
+	if (!right || (right->_length == 0)) {
+		_cstr_rope_release(allocator, right);
+		return left;
+	}
+
+	if (_cstr_rope_is_leaf(left) && _cstr_rope_is_leaf(right) && (left->_length + right->_length <= CSTR_ROPE_CHUNK)) {
+		cstr_rope_node_t *node = allocator->alloc(allocator->context, sizeof(cstr_rope_node_t) + left->_length + right->_length);
+		assert(node && "failed to allocate rope node!");
+
+		atomic_init(&node->_refs, 1);
+		node->_length = left->_length + right->_length;
+		node->_height = 1;
+		node->_left = NULL;
+		node->_right = NULL;
+		memcpy(node->_text, left->_text, left->_length);
+		memcpy(node->_text + left->_length, right->_text, right->_length);
+
+		_cstr_rope_release(allocator, left);
+		_cstr_rope_release(allocator, right);
+		return node;
+	}
+
+	if (left->_height > right->_height + 1)
+		return _cstr_rope_join_right(allocator, left, right);
+
+	if (right->_height > left->_height + 1)
+		return _cstr_rope_join_left(allocator, left, right);
+
+	return _cstr_rope_inner(allocator, left, right);
+}
+
+void
+_cstr_rope_split
+(const cstr_allocator_t *allocator, cstr_rope_node_t *node, size_t pos, cstr_rope_node_t **left, cstr_rope_node_t **right)
+{
+	if (!node || (pos == 0)) {
+		*left = NULL;
+		*right = node;
+		return;
+	}
+
+	if (pos >= node->_length) {
+		*left = node;
+		*right = NULL;
+		return;
+	}
+
+	if (_cstr_rope_is_leaf(node)) {
+		*left = _cstr_rope_leaf(allocator, node->_text, pos);
+		*right = _cstr_rope_leaf(allocator, node->_text + pos, node->_length - pos);
+
+		_cstr_rope_release(allocator, node);
+		return;
+	}
+
+	cstr_rope_node_t *a, *b, *middle;
+	_cstr_rope_unpack(allocator, node, &a, &b);
+
+	size_t left_length = a->_length;
+	if (pos < left_length) {
+		_cstr_rope_split(allocator, a, pos, left, &middle);
+		*right = _cstr_rope_join(allocator, middle, b);
+	}
+	else {
+		_cstr_rope_split(allocator, b, pos - left_length, &middle, right);
+		*left = _cstr_rope_join(allocator, a, middle);
+	}
+}
+
+cstr_rope_node_t *
+_cstr_rope_build
+(const cstr_allocator_t *allocator, const char *text, size_t len)
+{
+	if (len == 0)
+		return NULL;
+
+	if (len <= CSTR_ROPE_CHUNK)
+		return _cstr_rope_leaf(allocator, text, len);
+
+	size_t chunks = (len + CSTR_ROPE_CHUNK - 1) / CSTR_ROPE_CHUNK;
+	size_t half = (chunks / 2) * CSTR_ROPE_CHUNK;
+
+	return _cstr_rope_inner(
+		allocator,
+		_cstr_rope_build(allocator, text, half),
+		_cstr_rope_build(allocator, text + half, len - half)
+	);
+}
+
+cstr_rope_t *
+_cstr_rope_wrap
+(const cstr_allocator_t *allocator, cstr_rope_node_t *root)
+{
+	cstr_rope_t *rope = allocator->alloc(allocator->context, sizeof(cstr_rope_t));
+	assert(rope && "failed to allocate rope!");
+
+	rope->_allocator = allocator;
+	rope->_root = root;
+
+	return rope;
+}
+
+cstr_rope_t *
+cstr_rope_new
+(const char *string, size_t len)
+{
+	assert((string || (len == 0)) && "string argument must be valid!");
+
+	const cstr_allocator_t *allocator = _cstr_global_allocator;
+
+	return _cstr_rope_wrap(allocator, _cstr_rope_build(allocator, string, len));
+}
+
+cstr_rope_t *
+cstr_rope_from_string
+(string_t string)
+{
+	return cstr_rope_new(string, cstr_size(string));
+}
+
+cstr_rope_t *
+cstr_rope_clone
+(const cstr_rope_t *rope)
+{
+	assert(rope && "rope argument must be valid!");
+
+	return _cstr_rope_wrap(rope->_allocator, _cstr_rope_retain(rope->_root));
+}
+
+void
+cstr_rope_destroy
+(cstr_rope_t *rope)
+{
+	if (!rope)
+		return;
+
+	const cstr_allocator_t *allocator = rope->_allocator;
+
+	_cstr_rope_release(allocator, rope->_root);
+	allocator->free(allocator->context, rope, sizeof(cstr_rope_t));
+}
+
+size_t
+cstr_rope_length
+(const cstr_rope_t *rope)
+{
+	assert(rope && "rope argument must be valid!");
+
+	return _cstr_rope_length(rope->_root);
+}
+
+char
+cstr_rope_at
+(const cstr_rope_t *rope, size_t pos)
+{
+	assert(rope && "rope argument must be valid!");
+	assert((pos < cstr_rope_length(rope)) && "'pos' argument is out of range!");
+
+	const cstr_rope_node_t *node = rope->_root;
+	while (!_cstr_rope_is_leaf(node)) {
+		if (pos < node->_left->_length) {
+			node = node->_left;
+		}
+		else {
+			pos -= node->_left->_length;
+			node = node->_right;
+		}
+	}
+
+	return node->_text[pos];
+}
+
+void
+cstr_rope_insert
+(cstr_rope_t *rope, size_t pos, const char *string, size_t len)
+{
+	assert(rope && "rope argument must be valid!");
+	assert((string || (len == 0)) && "string argument must be valid!");
+	assert((pos <= cstr_rope_length(rope)) && "'pos' argument is out of range!");
+
+	const cstr_allocator_t *allocator = rope->_allocator;
+	cstr_rope_node_t *left, *right;
+
+	_cstr_rope_split(allocator, rope->_root, pos, &left, &right);
+	left = _cstr_rope_join(allocator, left, _cstr_rope_build(allocator, string, len));
+	rope->_root = _cstr_rope_join(allocator, left, right);
+}
+
+void
+cstr_rope_insert_rope
+(cstr_rope_t *rope, size_t pos, const cstr_rope_t *other)
+{
+	assert(rope && "rope argument must be valid!");
+	assert(other && "other argument must be valid!");
+	assert((pos <= cstr_rope_length(rope)) && "'pos' argument is out of range!");
+
+	const cstr_allocator_t *allocator = rope->_allocator;
+	cstr_rope_node_t *left, *right;
+	cstr_rope_node_t *shared = _cstr_rope_retain(other->_root);
+
+	_cstr_rope_split(allocator, rope->_root, pos, &left, &right);
+	left = _cstr_rope_join(allocator, left, shared);
+	rope->_root = _cstr_rope_join(allocator, left, right);
+}
+
+void
+cstr_rope_append
+(cstr_rope_t *rope, const char *string, size_t len)
+{
+	assert(rope && "rope argument must be valid!");
+
+	cstr_rope_insert(rope, cstr_rope_length(rope), string, len);
+}
+
+void
+cstr_rope_concat
+(cstr_rope_t *rope, const cstr_rope_t *other)
+{
+	assert(rope && "rope argument must be valid!");
+
+	cstr_rope_insert_rope(rope, cstr_rope_length(rope), other);
+}
+
+void
+cstr_rope_erase
+(cstr_rope_t *rope, size_t pos, size_t len)
+{
+	assert(rope && "rope argument must be valid!");
+	assert((pos <= cstr_rope_length(rope)) && "'pos' argument is out of range!");
+	assert((len <= (cstr_rope_length(rope) - pos)) && "'len' argument exceed limit!");
+
+	const cstr_allocator_t *allocator = rope->_allocator;
+	cstr_rope_node_t *left, *middle, *right;
+
+	_cstr_rope_split(allocator, rope->_root, pos, &left, &right);
+	_cstr_rope_split(allocator, right, len, &middle, &right);
+	_cstr_rope_release(allocator, middle);
+
+	rope->_root = _cstr_rope_join(allocator, left, right);
+}
+
+cstr_rope_t *
+cstr_rope_split
+(cstr_rope_t *rope, size_t pos)
+{
+	assert(rope && "rope argument must be valid!");
+	assert((pos <= cstr_rope_length(rope)) && "'pos' argument is out of range!");
+
+	cstr_rope_node_t *right;
+	_cstr_rope_split(rope->_allocator, rope->_root, pos, &rope->_root, &right);
+
+	return _cstr_rope_wrap(rope->_allocator, right);
+}
+
+cstr_rope_t *
+cstr_rope_substr
+(const cstr_rope_t *rope, size_t pos, size_t len)
+{
+	assert(rope && "rope argument must be valid!");
+	assert((pos <= cstr_rope_length(rope)) && "'pos' argument is out of range!");
+
+	const cstr_allocator_t *allocator = rope->_allocator;
+	cstr_rope_node_t *left, *middle, *right;
+
+	_cstr_rope_split(allocator, _cstr_rope_retain(rope->_root), pos, &left, &right);
+	_cstr_rope_release(allocator, left);
+
+	_cstr_rope_split(allocator, right, len, &middle, &right);
+	_cstr_rope_release(allocator, right);
+
+	return _cstr_rope_wrap(allocator, middle);
+}
+
+void
+cstr_rope_iter_init
+(cstr_rope_iter_t *iter, const cstr_rope_t *rope, size_t pos)
+{
+	assert(iter && "iter argument must be valid!");
+	assert(rope && "rope argument must be valid!");
+	assert((pos <= cstr_rope_length(rope)) && "'pos' argument is out of range!");
+
+	iter->_depth = 0;
+	iter->_offset = 0;
+
+	const cstr_rope_node_t *node = rope->_root;
+	if (!node)
+		return;
+
+	while (!_cstr_rope_is_leaf(node)) {
+		if (pos < node->_left->_length) {
+			iter->_stack[iter->_depth++] = node->_right;
+			node = node->_left;
+		}
+		else {
+			pos -= node->_left->_length;
+			node = node->_right;
+		}
+	}
+
+	iter->_stack[iter->_depth++] = node;
+	iter->_offset = pos;
+}
+
+bool
+cstr_rope_iter_next
+(cstr_rope_iter_t *iter, const char **chunk, size_t *len)
+{
+	assert(iter && "iter argument must be valid!");
+	assert(chunk && len && "chunk and len arguments must be valid!");
+
+	while (iter->_depth > 0) {
+		const cstr_rope_node_t *node = iter->_stack[--iter->_depth];
+
+		while (!_cstr_rope_is_leaf(node)) {
+			iter->_stack[iter->_depth++] = node->_right;
+			node = node->_left;
+		}
+
+		size_t offset = iter->_offset;
+		iter->_offset = 0;
+
+		if (offset < node->_length) {
+			*chunk = node->_text + offset;
+			*len = node->_length - offset;
+			return true;
+		}
+	}
+
+	return false;
+}
 
 string_t
-cstr_insert_substring
-(string_t string, size_t pos, const string_t insert_str, size_t subpos, size_t sublen)
+cstr_rope_flatten
+(const cstr_rope_t *rope)
 {
-	assert(insert_str && "insert_str argument must be valid!");
+	assert(rope && "rope argument must be valid!");
+
+	size_t length = cstr_rope_length(rope);
+	string_t string = _cstr_alloc(length, rope->_allocator);
+
+	cstr_rope_iter_t iter;
+	cstr_rope_iter_init(&iter, rope, 0);
+
+	const char *chunk;
+	size_t len, at = 0;
+	while (cstr_rope_iter_next(&iter, &chunk, &len)) {
+		memcpy(string + at, chunk, len);
+		at += len;
+	}
+
+	_cstr_set_size(string, length);
+	return string;
+}
+
+size_t
+cstr_rope_find
+(const cstr_rope_t *rope, const char *find_str, size_t pos, size_t n)
+{
+	assert(rope && "rope argument must be valid!");
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_rope_length(rope)) && "'pos' argument is out of range!");
+
+	if (n == 0)
+		return pos;
+
+	char stack_window[CSTR_SPLIT_WINDOW];
+	size_t window_size = 2 * (n - 1);
+	char *window = ((window_size <= CSTR_SPLIT_WINDOW) ? stack_window : _cstr_temp_alloc(window_size));
+
+	cstr_rope_iter_t iter;
+	cstr_rope_iter_init(&iter, rope, pos);
+
+	const char *chunk;
+	size_t len, base = pos, carry = 0;
+	size_t found = CSTR_NPOS;
+
+	while (cstr_rope_iter_next(&iter, &chunk, &len)) {
+		if (carry > 0) {
+			size_t head = ((len < n - 1) ? len : (n - 1));
+			memcpy(window + carry, chunk, head);
+
+			size_t offset = _cstr_search(window, carry + head, find_str, n);
+			if ((offset != CSTR_NPOS) && (offset < carry)) {
+				found = base - carry + offset;
+				break;
+			}
+		}
+
+		size_t offset = _cstr_search(chunk, len, find_str, n);
+		if (offset != CSTR_NPOS) {
+			found = base + offset;
+			break;
+		}
+
+		if (len >= n - 1) {
+			carry = n - 1;
+			memcpy(window, chunk + len - carry, carry);
+		}
+		else {
+			size_t keep = ((carry < n - 1 - len) ? carry : (n - 1 - len));
+			memmove(window, window + carry - keep, keep);
+			memcpy(window + keep, chunk, len);
+			carry = keep + len;
+		}
+
+		base += len;
+	}
+
+	if (window != stack_window)
+		_cstr_temp_free(window, window_size);
+
+	return found;
+}
+
+struct cstr_gap_t
+{
+	const cstr_allocator_t *	_allocator;
+	char *						_buffer;
+	size_t						_capacity;
+	size_t						_gap_start;
+	size_t						_gap_end;
+};
+
+size_t
+_cstr_gap_tail
+(const cstr_gap_t *gap)
+{
+	return gap->_capacity - gap->_gap_end;
+}
+
+void
+_cstr_gap_reserve
+(cstr_gap_t *gap, size_t len)
+{
+	if (gap->_gap_end - gap->_gap_start >= len)
+		return;
+
+	size_t tail = _cstr_gap_tail(gap);
+	size_t required = gap->_gap_start + len + tail;
+
+	size_t capacity = (gap->_capacity > CSTR_GAP_DEFAULT_CAPACITY) ? gap->_capacity : CSTR_GAP_DEFAULT_CAPACITY;
+	while (capacity < required) {
+		size_t grown = (size_t)((double)capacity * _cstr_policy.growth_factor);
+		capacity = (grown > capacity) ? grown : (capacity + 1);
+	}
+
+	const cstr_allocator_t *allocator = gap->_allocator;
+	char *buffer = allocator->realloc(allocator->context, gap->_buffer, gap->_capacity, capacity);
+	assert(buffer && "failed to grow gap buffer!");
+
+	memmove(buffer + capacity - tail, buffer + gap->_gap_end, tail);
+
+	gap->_buffer = buffer;
+	gap->_gap_end = capacity - tail;
+	gap->_capacity = capacity;
+}
+
+cstr_gap_t *
+cstr_gap_new
+(const char *string, size_t len)
+{
+	assert((string || (len == 0)) && "string argument must be valid!");
+
+	const cstr_allocator_t *allocator = _cstr_global_allocator;
+
+	cstr_gap_t *gap = allocator->alloc(allocator->context, sizeof(cstr_gap_t));
+	assert(gap && "failed to allocate gap buffer!");
+
+	size_t capacity = CSTR_GAP_DEFAULT_CAPACITY;
+	while (capacity < len + CSTR_GAP_DEFAULT_CAPACITY)
+		capacity <<= 1;
+
+	gap->_allocator = allocator;
+	gap->_buffer = allocator->alloc(allocator->context, capacity);
+	assert(gap->_buffer && "failed to allocate gap buffer!");
+
+	gap->_capacity = capacity;
+	gap->_gap_start = len;
+	gap->_gap_end = capacity;
+
+	if (len > 0)
+		memcpy(gap->_buffer, string, len);
+
+	return gap;
+}
+
+cstr_gap_t *
+cstr_gap_from_string
+(string_t string)
+{
+	return cstr_gap_new(string, cstr_size(string));
+}
+
+void
+cstr_gap_destroy
+(cstr_gap_t *gap)
+{
+	if (!gap)
+		return;
+
+	const cstr_allocator_t *allocator = gap->_allocator;
+
+	allocator->free(allocator->context, gap->_buffer, gap->_capacity);
+	allocator->free(allocator->context, gap, sizeof(cstr_gap_t));
+}
+
+size_t
+cstr_gap_length
+(const cstr_gap_t *gap)
+{
+	assert(gap && "gap argument must be valid!");
+
+	return gap->_gap_start + _cstr_gap_tail(gap);
+}
+
+size_t
+cstr_gap_cursor
+(const cstr_gap_t *gap)
+{
+	assert(gap && "gap argument must be valid!");
+
+	return gap->_gap_start;
+}
+
+char
+cstr_gap_at
+(const cstr_gap_t *gap, size_t pos)
+{
+	assert((pos < cstr_gap_length(gap)) && "'pos' argument is out of range!");
+
+	if (pos < gap->_gap_start)
+		return gap->_buffer[pos];
+
+	return gap->_buffer[gap->_gap_end + (pos - gap->_gap_start)];
+}
+
+void
+cstr_gap_move
+(cstr_gap_t *gap, size_t pos)
+{
+	assert((pos <= cstr_gap_length(gap)) && "'pos' argument is out of range!");
+
+	if (pos < gap->_gap_start) {
+		size_t len = gap->_gap_start - pos;
+		memmove(gap->_buffer + gap->_gap_end - len, gap->_buffer + pos, len);
+
+		gap->_gap_start -= len;
+		gap->_gap_end -= len;
+	}
+	else if (pos > gap->_gap_start) {
+		size_t len = pos - gap->_gap_start;
+		memmove(gap->_buffer + gap->_gap_start, gap->_buffer + gap->_gap_end, len);
+
+		gap->_gap_start += len;
+		gap->_gap_end += len;
+	}
+}
+
+void
+cstr_gap_insert
+(cstr_gap_t *gap, const char *string, size_t len)
+{
+	assert(gap && "gap argument must be valid!");
+	assert((string || (len == 0)) && "string argument must be valid!");
+
+	_cstr_gap_reserve(gap, len);
+
+	memcpy(gap->_buffer + gap->_gap_start, string, len);
+	gap->_gap_start += len;
+}
+
+void
+cstr_gap_erase
+(cstr_gap_t *gap, size_t len)
+{
+	assert(gap && "gap argument must be valid!");
+	assert((len <= _cstr_gap_tail(gap)) && "'len' argument exceed limit!");
+
+	gap->_gap_end += len;
+}
+
+void
+cstr_gap_backspace
+(cstr_gap_t *gap, size_t len)
+{
+	assert(gap && "gap argument must be valid!");
+	assert((len <= gap->_gap_start) && "'len' argument exceed limit!");
+
+	gap->_gap_start -= len;
+}
+
+string_t
+cstr_gap_materialize
+(const cstr_gap_t *gap)
+{
+	size_t length = cstr_gap_length(gap);
+	size_t tail = _cstr_gap_tail(gap);
+
+	string_t string = _cstr_alloc(length, gap->_allocator);
+	memcpy(string, gap->_buffer, gap->_gap_start);
+	memcpy(string + gap->_gap_start, gap->_buffer + gap->_gap_end, tail);
+
+	_cstr_set_size(string, length);
+	return string;
+}
+
+size_t
+cstr_gap_find
+(const cstr_gap_t *gap, const char *find_str, size_t pos, size_t n)
+{
+	assert(find_str && "find_str argument must be valid!");
+	assert((pos <= cstr_gap_length(gap)) && "'pos' argument is out of range!");
+
+	const char *right = gap->_buffer + gap->_gap_end;
+	size_t left_len = gap->_gap_start;
+	size_t right_len = _cstr_gap_tail(gap);
+
+	if (pos >= left_len) {
+		size_t offset = _cstr_search(right + (pos - left_len), right_len - (pos - left_len), find_str, n);
+		return ((offset == CSTR_NPOS) ? CSTR_NPOS : (pos + offset));
+	}
 
-	size_t length = cstr_length(insert_str);
-	if (subpos < length) {
-		size_t actual_sublen = ((sublen > (length - subpos)) ? (length - subpos) : sublen);
-		return cstr_insert_n(string, pos, cstr_data(insert_str) + subpos, actual_sublen);
+	size_t offset = _cstr_search(gap->_buffer + pos, left_len - pos, find_str, n);
+	if (offset != CSTR_NPOS)
+		return (pos + offset);
+
+	if ((n > 1) && (right_len > 0)) {
+		size_t start = ((left_len - pos > n - 1) ? (left_len - (n - 1)) : pos);
+		size_t carry = left_len - start;
+		size_t head = ((right_len < n - 1) ? right_len : (n - 1));
+
+		char stack_window[CSTR_SPLIT_WINDOW];
+		size_t window_size = carry + head;
+		char *window = ((window_size <= CSTR_SPLIT_WINDOW) ? stack_window : _cstr_temp_alloc(window_size));
+
+		memcpy(window, gap->_buffer + start, carry);
+		memcpy(window + carry, right, head);
+		offset = _cstr_search(window, window_size, find_str, n);
+
+		if (window != stack_window)
+			_cstr_temp_free(window, window_size);
+
+		if ((offset != CSTR_NPOS) && (offset < carry))
+			return (start + offset);
 	}
 
-	return string;
+	offset = _cstr_search(right, right_len, find_str, n);
+	return ((offset == CSTR_NPOS) ? CSTR_NPOS : (left_len + offset));
 }
 
-string_t
-cstr_insert_fill
-(string_t string, size_t pos, size_t n, char c)
+int
+cstr_gap_compare
+(const cstr_gap_t *gap, const char *compare_str, size_t n)
 {
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t new_size = old_size + n;
+	assert(compare_str && "compare_str argument must be valid!");
 
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
-	}
-	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
-	}
+	size_t left_len = gap->_gap_start;
+	size_t right_len = _cstr_gap_tail(gap);
 
-	size_t move_size = old_size - pos;
-	memmove(
-		(string_t)(header->_begin) + (pos + n),
-		(string_t)(header->_begin) + pos,
-		move_size
-	);
+	if (n <= left_len)
+		return _cstr_compare_mem(gap->_buffer, left_len + right_len, compare_str, n);
 
-	for (size_t i = pos; i < pos + n; ++i)
-		((char *)header->_begin)[i] = c;
+	int res = memcmp(gap->_buffer, compare_str, left_len);
+	if (res != 0)
+		return res;
 
-	((char *)header->_end)[1] = '\0';
-	return (header->_begin);
+	return _cstr_compare_mem(gap->_buffer + gap->_gap_end, right_len, compare_str + left_len, n - left_len);
 }
 
-string_t
-cstr_insert_range
-(string_t string, size_t pos, const void *start, const void *end)
+int
+cstr_gap_compare_string
+(const cstr_gap_t *gap, const string_t compare_str)
 {
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t insert_length = (ptrdiff_t)((char *)end - (char *)start);
-	size_t new_size = old_size + insert_length;
+	assert(compare_str && "compare_str argument must be valid!");
 
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
-	}
-	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
-	}
+	return cstr_gap_compare(gap, compare_str, _cstr_get_size(compare_str));
+}
 
-	size_t move_size = old_size - pos;
-	memmove(
-		(string_t)(header->_begin) + (pos + insert_length),
-		(string_t)(header->_begin) + pos,
-		move_size
-	);
 
-	memcpy((string_t)(header->_begin) + pos, start, insert_length);
+const uint64_t _cstr_hash_secret[4] = {
+	0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+};
 
-	((char *)header->_end)[1] = '\0';
-	return (header->_begin);
+void
+_cstr_hash_mum
+(uint64_t *a, uint64_t *b)
+{
+#if	defined(__SIZEOF_INT128__)
+	__uint128_t r = (__uint128_t)*a * *b;
+	*a = (uint64_t)r;
+	*b = (uint64_t)(r >> 64);
+#else
+	uint64_t ha = *a >> 32, la = (uint32_t)*a;
+	uint64_t hb = *b >> 32, lb = (uint32_t)*b;
+
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32);
+	uint64_t c = (t < rl);
+	uint64_t lo = t + (rm1 << 32);
+	c += (lo < t);
+
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
 }
 
-string_t
-cstr_erase
-(string_t string, size_t pos, size_t len)
+uint64_t
+_cstr_hash_mix
+(uint64_t a, uint64_t b)
 {
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
-	assert((len <= (cstr_size(string) - pos)) && "'len' argument exceeds limit!");
+	_cstr_hash_mum(&a, &b);
+	return (a ^ b);
+}
 
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t new_size = old_size - len;
+uint64_t
+_cstr_hash_read8
+(const uint8_t *p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
 
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
+uint64_t
+_cstr_hash_read4
+(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+uint64_t
+_cstr_hash_bytes
+(const void *data, size_t len, uint64_t seed)
+{
+	const uint8_t *p = data;
+	const uint64_t *secret = _cstr_hash_secret;
+	uint64_t a, b;
+
+	seed ^= _cstr_hash_mix(seed ^ secret[0], secret[1]);
+
+	if (len <= 16) {
+		if (len >= 4) {
+			size_t offset = ((len >> 3) << 2);
+			a = (_cstr_hash_read4(p) << 32) | _cstr_hash_read4(p + offset);
+			b = (_cstr_hash_read4(p + len - 4) << 32) | _cstr_hash_read4(p + len - 4 - offset);
+		}
+		else if (len > 0) {
+			a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+			b = 0;
+		}
+		else {
+			a = 0;
+			b = 0;
+		}
 	}
 	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
+		size_t i = len;
+
+		if (i > 48) {
+			uint64_t see1 = seed, see2 = seed;
+
+			do {
+				seed = _cstr_hash_mix(_cstr_hash_read8(p) ^ secret[1], _cstr_hash_read8(p + 8) ^ seed);
+				see1 = _cstr_hash_mix(_cstr_hash_read8(p + 16) ^ secret[2], _cstr_hash_read8(p + 24) ^ see1);
+				see2 = _cstr_hash_mix(_cstr_hash_read8(p + 32) ^ secret[3], _cstr_hash_read8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+
+			seed ^= see1 ^ see2;
+		}
+
+		while (i > 16) {
+			seed = _cstr_hash_mix(_cstr_hash_read8(p) ^ secret[1], _cstr_hash_read8(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+
+		a = _cstr_hash_read8(p + i - 16);
+		b = _cstr_hash_read8(p + i - 8);
 	}
 
-	size_t move_size = old_size - pos;
-	memmove(
-		(string_t)(header->_begin) + pos,
-		(string_t)(header->_begin) + (pos + len),
-		move_size
-	);
+	a ^= secret[1];
+	b ^= seed;
+	_cstr_hash_mum(&a, &b);
 
-	((char *)header->_end)[1] = '\0';
-	return (header->_begin);
+	return _cstr_hash_mix(a ^ secret[0] ^ len, b ^ secret[1]);
 }
 
-string_t
-cstr_erase_range
-(string_t string, const void *start, const void *end)
+void
+_cstr_hash_store
+(string_t string, uint64_t seed, uint64_t hash)
 {
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t erase_length = (ptrdiff_t)((char *)end - (char *)start);
-	size_t new_size = old_size - erase_length;
+	cstr_shared_t *shared = _cstr_shared(string);
 
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
-	}
-	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
-	}
+	unsigned seq = atomic_load_explicit(&shared->_hash_seq, memory_order_relaxed);
+	if ((seq & 1u) || !atomic_compare_exchange_strong_explicit(&shared->_hash_seq, &seq, seq + 1u, memory_order_relaxed, memory_order_relaxed))
+		return;
+
+	atomic_thread_fence(memory_order_release);
+	atomic_store_explicit(&shared->_hash, hash, memory_order_relaxed);
+	atomic_store_explicit(&shared->_seed, seed, memory_order_relaxed);
+	atomic_store_explicit(&shared->_hash_seq, seq + 2u, memory_order_release);
+}
+
+bool
+_cstr_hash_load
+(string_t string, uint64_t seed, uint64_t *hash)
+{
+	cstr_shared_t *shared = _cstr_shared(string);
 
-	size_t move_size = old_size - erase_length;
-	string_t move_dest = (string_t)start;
-	memmove(move_dest, end, move_size);
+	unsigned seq = atomic_load_explicit(&shared->_hash_seq, memory_order_acquire);
+	if ((seq == 0) || (seq & 1u))
+		return false;
 
-	((char *)header->_end)[1] = '\0';
-	return (header->_begin);
+	uint64_t cached_hash = atomic_load_explicit(&shared->_hash, memory_order_relaxed);
+	uint64_t cached_seed = atomic_load_explicit(&shared->_seed, memory_order_relaxed);
+	atomic_thread_fence(memory_order_acquire);
+
+	if ((atomic_load_explicit(&shared->_hash_seq, memory_order_relaxed) != seq) || (cached_seed != seed))
+		return false;
+
+	*hash = cached_hash;
+	return true;
 }
 
-string_t
-cstr_replace
-(string_t string, size_t pos, size_t len, const char *replace_str)
+void
+_cstr_prefetch
+(const void *ptr)
 {
-	assert(replace_str && "replace_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "pos argument is out of range!");
-	assert((len <= (cstr_size(string) - pos)) && "'len' argument exceed limit!");
+#if	defined(__GNUC__)
+	__builtin_prefetch(ptr);
+#else
+	(void)ptr;
+#endif
+}
 
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t replace_length = strlen(replace_str);
-	size_t new_size = old_size - len + replace_length;
 
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
-	}
-	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
-	}
+uint64_t
+cstr_hash
+(string_t string, uint64_t seed)
+{
+	assert(string && "string argument must be valid!");
 
-	size_t move_size = old_size - (pos + len);
-	memmove(
-		(string_t)(header->_begin) + (pos + replace_length),
-		(string_t)(header->_begin) + (pos + len),
-		move_size
-	);
+	if (!(_cstr_flags(string) & CSTR_FLAG_SHARED))
+		return _cstr_hash_bytes(string, _cstr_get_size(string), seed);
+
+	uint64_t hash;
+	if (_cstr_hash_load(string, seed, &hash))
+		return hash;
 
-	memcpy((string_t)(header->_begin) + pos, replace_str, replace_length);
-	((char *)header->_end)[1] = '\0';
-	return (header->_begin);
+	hash = _cstr_hash_bytes(string, _cstr_get_size(string), seed);
+	_cstr_hash_store(string, seed, hash);
+
+	return hash;
 }
 
-string_t
-cstr_replace_n
-(string_t string, size_t pos, size_t len, const char *replace_str, size_t n)
+uint64_t
+cstr_hash_n
+(const char *string, size_t len, uint64_t seed)
 {
-	assert(replace_str && "replace_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "pos argument is out of range!");
-	assert((len <= (cstr_size(string) - pos)) && "'len' argument exceed limit!");
-	assert((n <= strlen(replace_str)) && "'n' argument exceed replace_str length!");
+	assert((string || (len == 0)) && "string argument must be valid!");
 
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t new_size = old_size - len + n;
+	return _cstr_hash_bytes(string ? string : "", len, seed);
+}
 
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
+void
+cstr_hash_many
+(const string_t *strings, size_t count, uint64_t seed, uint64_t *hashes)
+{
+	assert((strings || (count == 0)) && "strings argument must be valid!");
+	assert((hashes || (count == 0)) && "hashes argument must be valid!");
+
+	size_t warmup = (count < CSTR_HASH_PREFETCH_DISTANCE) ? count : CSTR_HASH_PREFETCH_DISTANCE;
+	for (size_t i = 0; i < warmup; ++i) {
+		_cstr_prefetch(strings[i] - sizeof(cstr_shared_t) - sizeof(string_header64_t));
+		_cstr_prefetch(strings[i]);
 	}
-	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
+
+	for (size_t i = 0; i < count; ++i) {
+		if (i + CSTR_HASH_PREFETCH_DISTANCE < count) {
+			string_t ahead = strings[i + CSTR_HASH_PREFETCH_DISTANCE];
+			_cstr_prefetch(ahead - sizeof(cstr_shared_t) - sizeof(string_header64_t));
+			_cstr_prefetch(ahead);
+		}
+
+		hashes[i] = cstr_hash(strings[i], seed);
 	}
+}
 
-	size_t move_size = old_size - (pos + len);
-	memmove(
-		(string_t)(header->_begin) + (pos + n),
-		(string_t)(header->_begin) + (pos + len),
-		move_size
-	);
+void
+cstr_hash_invalidate
+(string_t string)
+{
+	assert(string && "string argument must be valid!");
 
-	memcpy((string_t)(header->_begin) + pos, replace_str, n);
-	((char *)header->_end)[1] = '\0';
-	return (header->_begin);
+	_cstr_invalidate_hash(string);
 }
 
-string_t
-cstr_replace_string
-(string_t string, size_t pos, size_t len, const string_t replace_str)
+
+typedef struct cstr_intern_slot_t
 {
-	assert(replace_str && "replace_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "pos argument is out of range!");
-	assert((len <= (cstr_size(string) - pos)) && "'len' argument exceed limit!");
+	string_t	_string;
+	uint64_t	_hash;
+	size_t		_epoch;
+}
+cstr_intern_slot_t;
 
-	return cstr_replace(string, pos, len, cstr_data(replace_str));
+typedef struct cstr_intern_shard_t
+{
+	_Alignas(64) atomic_int	_lock;
+	cstr_intern_slot_t *	_slots;
+	size_t					_capacity;
+	size_t					_count;
+	size_t					_used;
+	size_t					_bytes;
+	size_t					_hits;
+	size_t					_misses;
+	size_t					_bytes_saved;
+	size_t					_evictions;
 }
+cstr_intern_shard_t;
 
-string_t
-cstr_replace_substring
-(string_t string, size_t pos, size_t len, const string_t replace_str, size_t subpos, size_t sublen)
+cstr_intern_shard_t _cstr_intern_shards[CSTR_INTERN_SHARDS];
+
+char _cstr_intern_tombstone;
+
+atomic_size_t _cstr_intern_epoch;
+atomic_size_t _cstr_intern_max_age;
+
+
+void
+_cstr_intern_lock
+(cstr_intern_shard_t *shard)
 {
-	assert(replace_str && "replace_str argument must be valid!");
+	int expected = 0;
+	while (!atomic_compare_exchange_weak_explicit(&shard->_lock, &expected, 1, memory_order_acquire, memory_order_relaxed))
+		expected = 0;
+}
 
-	size_t length = cstr_length(replace_str);
-	if (subpos < length) {
-		size_t actual_sublen = ((sublen > (length - subpos)) ? (length - subpos) : sublen);
-		return cstr_replace_n(string, pos, len, cstr_data(replace_str) + subpos, actual_sublen);
-	}
+void
+_cstr_intern_unlock
+(cstr_intern_shard_t *shard)
+{
+	atomic_store_explicit(&shard->_lock, 0, memory_order_release);
+}
 
-	return string;
+cstr_intern_shard_t *
+_cstr_intern_shard
+(uint64_t hash)
+{
+	return &_cstr_intern_shards[(hash >> 58) % CSTR_INTERN_SHARDS];
 }
 
-string_t
-cstr_replace_fill
-(string_t string, size_t pos, size_t len, size_t n, char c)
+bool
+_cstr_intern_live
+(const cstr_intern_slot_t *slot)
 {
-	assert((pos <= cstr_size(string)) && "pos argument is out of range!");
-	assert((len <= (cstr_size(string) - pos)) && "'len' argument exceed limit!");
+	return (slot->_string && (slot->_string != &_cstr_intern_tombstone));
+}
 
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t new_size = old_size - len + n;
+void
+_cstr_intern_rehash
+(cstr_intern_shard_t *shard, size_t capacity)
+{
+	const cstr_allocator_t *allocator = &_cstr_default_allocator;
 
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
-	}
-	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
-	}
+	cstr_intern_slot_t *slots = allocator->alloc(allocator->context, capacity * sizeof(cstr_intern_slot_t));
+	assert(slots && "failed to allocate intern table!");
+	memset(slots, 0, capacity * sizeof(cstr_intern_slot_t));
 
-	size_t move_size = old_size - (pos + len);
-	memmove(
-		(string_t)(header->_begin) + (pos + n),
-		(string_t)(header->_begin) + (pos + len),
-		move_size
-	);
+	for (size_t i = 0; i < shard->_capacity; ++i) {
+		if (!_cstr_intern_live(&shard->_slots[i]))
+			continue;
+
+		size_t index = (size_t)shard->_slots[i]._hash & (capacity - 1);
+		while (slots[index]._string)
+			index = (index + 1) & (capacity - 1);
+
+		slots[index] = shard->_slots[i];
+	}
 
-	for (size_t i = pos; i < pos + n; ++i)
-		((char *)header->_begin)[i] = c;
+	if (shard->_slots)
+		allocator->free(allocator->context, shard->_slots, shard->_capacity * sizeof(cstr_intern_slot_t));
 
-	((char *)header->_end)[1] = '\0';
-	return (header->_begin);
+	shard->_slots = slots;
+	shard->_capacity = capacity;
+	shard->_used = shard->_count;
 }
 
 string_t
-cstr_replace_range
-(string_t string, size_t pos, size_t len, const void *start, const void *end)
+_cstr_intern_insert
+(cstr_intern_shard_t *shard, const char *string, size_t len, uint64_t hash, size_t epoch)
 {
-	string_header_t *header = _cstr_header(string);
-	size_t old_size = header->_size;
-	size_t replace_length = (ptrdiff_t)((char *)end - (char *)start);
-	size_t new_size = old_size - len + replace_length;
+	if ((shard->_used + 1) * 4 > shard->_capacity * 3) {
+		size_t capacity = (shard->_capacity > 0) ? shard->_capacity : CSTR_INTERN_MIN_SLOTS;
+		while ((shard->_count + 1) * 2 > capacity)
+			capacity <<= 1;
 
-	if (new_size >= header->_capacity) {
-		string = _cstr_expand(string, new_size);
-		header = _cstr_header(string);
-	}
-	else {
-		header->_size = new_size;
-		header->_end = (string_t)(header->_begin) + (new_size - 1);
+		_cstr_intern_rehash(shard, capacity);
 	}
 
-	size_t move_size = old_size - (pos + len);
-	memmove(
-		(string_t)(header->_begin) + (pos + replace_length),
-		(string_t)(header->_begin) + (pos + len),
-		move_size
-	);
+	string_t canonical = _cstr_alloc_ext(len, &_cstr_default_allocator, CSTR_FLAG_SHARED);
+	memcpy(canonical, string, len);
+	_cstr_set_size(canonical, len);
+	((uint8_t *)canonical)[-1] |= CSTR_FLAG_STATIC;
+	_cstr_hash_store(canonical, 0, hash);
+
+	size_t index = (size_t)hash & (shard->_capacity - 1);
+	while (_cstr_intern_live(&shard->_slots[index]))
+		index = (index + 1) & (shard->_capacity - 1);
+
+	if (!shard->_slots[index]._string)
+		++shard->_used;
+
+	shard->_slots[index]._string = canonical;
+	shard->_slots[index]._hash = hash;
+	shard->_slots[index]._epoch = epoch;
 
-	memcpy((string_t)(header->_begin) + pos, start, replace_length);
+	++shard->_count;
+	shard->_bytes += _cstr_block_size(canonical);
 
-	((char *)header->_end)[1] = '\0';
-	return (header->_begin);
+	return canonical;
 }
 
 void
-cstr_swap
-(string_t *left, string_t *right)
+_cstr_intern_drop
+(cstr_intern_shard_t *shard, cstr_intern_slot_t *slot)
 {
-	if (_cstr_invalid(*left))
-		*left = cstr_new(*left);
+	shard->_bytes -= _cstr_block_size(slot->_string);
+	--shard->_count;
 
-	if (_cstr_invalid(*right))
-		*right = cstr_new(*right);
-
-	string_t temp = *left;
-	*left = *right;
-	*right = temp;
+	cstr_release(slot->_string);
+	slot->_string = &_cstr_intern_tombstone;
 }
 
-size_t
-cstr_copy
-(string_t string, char *s, size_t len, size_t pos)
+string_t
+_cstr_intern
+(const char *string, size_t len, uint64_t hash)
 {
-	assert((pos <= cstr_size(string)) && "pos argument is out of range!");
-	assert((len <= (cstr_size(string) - pos)) && "'len' argument exceed limit!");
+	size_t epoch = atomic_load_explicit(&_cstr_intern_epoch, memory_order_relaxed);
 
-	string_header_t *header = _cstr_header(string);
+	cstr_intern_shard_t *shard = _cstr_intern_shard(hash);
+	_cstr_intern_lock(shard);
 
-	memcpy(s, (string_t)(header->_begin) + pos, len);
-	s[len] = '\0';
+	if (shard->_capacity > 0) {
+		size_t mask = shard->_capacity - 1;
 
-	return strlen(s);
+		for (size_t index = (size_t)hash & mask; shard->_slots[index]._string; index = (index + 1) & mask) {
+			cstr_intern_slot_t *slot = &shard->_slots[index];
+
+			if (!_cstr_intern_live(slot) || (slot->_hash != hash) || (_cstr_get_size(slot->_string) != len) || (memcmp(slot->_string, string, len) != 0))
+				continue;
+
+			slot->_epoch = epoch;
+			++shard->_hits;
+			shard->_bytes_saved += _cstr_block_size(slot->_string);
+
+			string_t canonical = cstr_retain(slot->_string);
+			_cstr_intern_unlock(shard);
+			return canonical;
+		}
+	}
+
+	++shard->_misses;
+	string_t canonical = cstr_retain(_cstr_intern_insert(shard, string, len, hash, epoch));
+
+	_cstr_intern_unlock(shard);
+	return canonical;
 }
 
-size_t
-cstr_find
-(string_t string, const char *find_str, size_t pos)
+
+string_t
+cstr_intern
+(const char *string, size_t len)
 {
-	assert(find_str && "find_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+	assert((string || (len == 0)) && "string argument must be valid!");
 
-	return (strstr(string + pos, find_str) - string);
+	if (!string)
+		string = "";
+
+	return _cstr_intern(string, len, _cstr_hash_bytes(string, len, 0));
 }
 
-size_t
-cstr_find_n
-(string_t string, const char *find_str, size_t pos, size_t n)
+string_t
+cstr_intern_string
+(string_t string)
 {
-	assert(find_str && "find_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
-
-	char *actual_find_str = strdup(find_str);
-	actual_find_str[n] = '\0';
+	assert(string && "string argument must be valid!");
 
-	size_t return_pos = cstr_find(string, actual_find_str, pos);
+	if (cstr_is_interned(string))
+		return cstr_retain(string);
 
-	free(actual_find_str);
-	return return_pos;
+	return _cstr_intern(string, _cstr_get_size(string), cstr_hash(string, 0));
 }
 
-size_t
-cstr_find_string
-(string_t string, const string_t find_str, size_t pos)
+bool
+cstr_is_interned
+(string_t string)
 {
-	return cstr_find(string, cstr_data(find_str), pos);
+	return ((_cstr_flags(string) & (CSTR_FLAG_STATIC | CSTR_FLAG_SHARED)) == (CSTR_FLAG_STATIC | CSTR_FLAG_SHARED));
 }
 
-size_t
-cstr_find_char
-(string_t string, char c, size_t pos)
+void
+cstr_intern_set_max_age
+(size_t epochs)
 {
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
-
-	return (strchr(string + pos, c) - string);
+	atomic_store_explicit(&_cstr_intern_max_age, epochs, memory_order_relaxed);
 }
 
 size_t
-cstr_rfind
-(string_t string, const char *find_str, size_t pos)
+cstr_intern_advance_epoch
+(void)
 {
-	assert(find_str && "find_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+	size_t epoch = atomic_fetch_add_explicit(&_cstr_intern_epoch, 1, memory_order_relaxed) + 1;
+	size_t max_age = atomic_load_explicit(&_cstr_intern_max_age, memory_order_relaxed);
+
+	if (max_age == 0)
+		return 0;
+
+	size_t evicted = 0;
+
+	for (size_t i = 0; i < CSTR_INTERN_SHARDS; ++i) {
+		cstr_intern_shard_t *shard = &_cstr_intern_shards[i];
+		_cstr_intern_lock(shard);
+
+		for (size_t j = 0; j < shard->_capacity; ++j) {
+			cstr_intern_slot_t *slot = &shard->_slots[j];
+
+			if (_cstr_intern_live(slot) && ((epoch - slot->_epoch) > max_age)) {
+				_cstr_intern_drop(shard, slot);
+				++shard->_evictions;
+				++evicted;
+			}
+		}
+
+		if ((shard->_capacity > CSTR_INTERN_MIN_SLOTS) && (shard->_count * 8 < shard->_capacity)) {
+			size_t capacity = CSTR_INTERN_MIN_SLOTS;
+			while (shard->_count * 2 > capacity)
+				capacity <<= 1;
 
-	char *ptr = string;
-	char *last = NULL;
+			_cstr_intern_rehash(shard, capacity);
+		}
 
-	while ((ptr = strstr(ptr, find_str)) != NULL)
-		last = ptr++;
+		_cstr_intern_unlock(shard);
+	}
 
-	return (last - string);
+	return evicted;
 }
 
-size_t
-cstr_rfind_n
-(string_t string, const char *find_str, size_t pos, size_t n)
+void
+cstr_intern_stats
+(cstr_intern_stats_t *stats)
 {
-	assert(find_str && "find_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+	assert(stats && "stats argument must be valid!");
 
-	char *ptr = string;
-	char *last = NULL;
+	memset(stats, 0, sizeof(*stats));
 
-	char *actual_find_str = strdup(find_str);
-	actual_find_str[n] = '\0';
+	for (size_t i = 0; i < CSTR_INTERN_SHARDS; ++i) {
+		cstr_intern_shard_t *shard = &_cstr_intern_shards[i];
+		_cstr_intern_lock(shard);
 
-	while ((ptr = strstr(ptr, actual_find_str)) != NULL)
-		last = ptr++;
+		stats->hits += shard->_hits;
+		stats->misses += shard->_misses;
+		stats->entries += shard->_count;
+		stats->bytes_stored += shard->_bytes + (shard->_capacity * sizeof(cstr_intern_slot_t));
+		stats->bytes_saved += shard->_bytes_saved;
+		stats->evictions += shard->_evictions;
 
-	free(actual_find_str);
-	return (last - string);
-}
+		_cstr_intern_unlock(shard);
+	}
 
-size_t
-cstr_rfind_string
-(string_t string, const string_t find_str, size_t pos)
-{
-	return cstr_rfind(string, cstr_data(find_str), pos);
+	size_t lookups = stats->hits + stats->misses;
+	stats->hit_rate = (lookups > 0) ? ((double)stats->hits / (double)lookups) : 0.0;
 }
 
-size_t
-cstr_rfind_char
-(string_t string, char c, size_t pos)
+void
+cstr_intern_reset
+(void)
 {
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+	const cstr_allocator_t *allocator = &_cstr_default_allocator;
 
-	return (strrchr(string + pos, c) - string);
-}
+	for (size_t i = 0; i < CSTR_INTERN_SHARDS; ++i) {
+		cstr_intern_shard_t *shard = &_cstr_intern_shards[i];
+		_cstr_intern_lock(shard);
 
-size_t
-cstr_find_first_of
-(string_t string, const char *find_str, size_t pos)
-{
-	assert(find_str && "find_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+		for (size_t j = 0; j < shard->_capacity; ++j) {
+			if (_cstr_intern_live(&shard->_slots[j]))
+				cstr_release(shard->_slots[j]._string);
+		}
 
-	return (strpbrk(string + pos, find_str) - string);
-}
+		if (shard->_slots)
+			allocator->free(allocator->context, shard->_slots, shard->_capacity * sizeof(cstr_intern_slot_t));
 
-size_t
-cstr_find_first_of_n
-(string_t string, const char *find_str, size_t pos, size_t n)
-{
-	assert(find_str && "find_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+		shard->_slots = NULL;
+		shard->_capacity = 0;
+		shard->_count = 0;
+		shard->_used = 0;
+		shard->_bytes = 0;
+		shard->_hits = 0;
+		shard->_misses = 0;
+		shard->_bytes_saved = 0;
+		shard->_evictions = 0;
 
-	char *actual_find_str = strdup(find_str);
-	actual_find_str[n] = '\0';
+		_cstr_intern_unlock(shard);
+	}
+}
 
-	size_t return_size = strpbrk(string + pos, actual_find_str) - string;
 
-	free(actual_find_str);
-	return return_size;
+typedef struct cstr_map_slot_t
+{
+	string_t	_key;
+	void *		_value;
 }
+cstr_map_slot_t;
 
-size_t
-cstr_find_first_of_string
-(string_t string, const string_t find_str, size_t pos)
+struct cstr_map_t
 {
-	return cstr_find_first_of(string, cstr_data(find_str), pos);
+	const cstr_allocator_t *	_allocator;
+	int8_t *					_ctrl;
+	cstr_map_slot_t *			_slots;
+	size_t						_capacity;
+	size_t						_count;
+	size_t						_growth_left;
+	uint64_t					_seed;
+	bool						_owns_keys;
+};
+
+uint32_t
+_cstr_map_match
+(const int8_t *ctrl, int8_t h2)
+{
+#if	defined(CSTR_HAS_SSE2)
+	__m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(h2)));
+#else
+	uint32_t mask = 0;
+	for (size_t i = 0; i < CSTR_MAP_GROUP; ++i)
+		mask |= (uint32_t)(ctrl[i] == h2) << i;
+
+	return mask;
+#endif
 }
 
-size_t
-cstr_find_first_of_char
-(string_t string, char c, size_t pos)
+uint32_t
+_cstr_map_match_empty
+(const int8_t *ctrl)
 {
-	return cstr_find_char(string, c, pos);
+	return _cstr_map_match(ctrl, CSTR_MAP_EMPTY);
 }
 
-size_t
-cstr_find_last_of
-(string_t string, const char *find_str, size_t pos)
+uint32_t
+_cstr_map_match_free
+(const int8_t *ctrl)
 {
-	assert(find_str && "find_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
-
-	size_t last_most = 0;
-	for (size_t i = 0; i < strlen(find_str); ++i) {
-		size_t last = strrchr(string + pos, find_str[i]) - string;
-
-		if ((last > last_most) && (last < cstr_size(string)))
-			last_most = last;
-	}
-
-	return last_most;
+#if	defined(CSTR_HAS_SSE2)
+	return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+#else
+	uint32_t mask = 0;
+	for (size_t i = 0; i < CSTR_MAP_GROUP; ++i)
+		mask |= (uint32_t)(ctrl[i] < 0) << i;
+
+	return mask;
+#endif
 }
 
 size_t
-cstr_find_last_of_n
-(string_t string, const char *find_str, size_t pos, size_t n)
+_cstr_map_first
+(uint32_t mask)
 {
-	assert(find_str && "find_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
-
-	size_t last_most = 0;
-	for (size_t i = 0; i < n; ++i) {
-		size_t last = strrchr(string + pos, find_str[i]) - string;
-
-		if ((last > last_most) && (last < cstr_size(string)))
-			last_most = last;
+#if	defined(__GNUC__)
+	return (size_t)__builtin_ctz(mask);
+#else
+	size_t bit = 0;
+	while (!(mask & 1u)) {
+		mask >>= 1;
+		++bit;
 	}
 
-	return last_most;
+	return bit;
+#endif
 }
 
 size_t
-cstr_find_last_of_string
-(string_t string, const string_t find_str, size_t pos)
+_cstr_map_table_size
+(size_t capacity)
 {
-	return cstr_find_last_of(string, cstr_data(find_str), pos);
+	return (capacity + CSTR_MAP_GROUP + (capacity * sizeof(cstr_map_slot_t)));
 }
 
 size_t
-cstr_find_last_of_char
-(string_t string, char c, size_t pos)
+_cstr_map_max_load
+(size_t capacity)
 {
-	return cstr_rfind_char(string, c, pos);
+	return (capacity - (capacity / 8));
 }
 
-size_t
-cstr_find_first_not_of
-(string_t string, const char *find_str, size_t pos)
+void
+_cstr_map_alloc_table
+(cstr_map_t *map, size_t capacity)
 {
-	assert(find_str && "find_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+	const cstr_allocator_t *allocator = map->_allocator;
 
-	for (size_t i = pos; i < cstr_size(string); ++i) {
-		char *current = strchr(find_str, string[i]);
-		
-		if (!current)
-			return i;
-	}
+	char *table = allocator->alloc(allocator->context, _cstr_map_table_size(capacity));
+	assert(table && "failed to allocate map table!");
 
-	return cstr_max_size(string);
+	map->_ctrl = (int8_t *)table;
+	map->_slots = (cstr_map_slot_t *)(table + capacity + CSTR_MAP_GROUP);
+	map->_capacity = capacity;
+	map->_growth_left = _cstr_map_max_load(capacity) - map->_count;
+
+	memset(map->_ctrl, (uint8_t)CSTR_MAP_EMPTY, capacity + CSTR_MAP_GROUP);
 }
 
-size_t
-cstr_find_first_not_of_n
-(string_t string, const char *find_str, size_t pos, size_t n)
+void
+_cstr_map_set_ctrl
+(cstr_map_t *map, size_t index, int8_t h)
 {
-	assert(find_str && "find_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
-
-	char *actual_find_str = strdup(find_str);
-	actual_find_str[n] = '\0';
-
-	for (size_t i = pos; i < cstr_size(string); ++i) {
-		char *current = strchr(actual_find_str, string[i]);
-
-		if (!current) {
-			free(actual_find_str);
-			return i;
-		}
-	}
-
-	free(actual_find_str);
-	return cstr_max_size(string);
+	map->_ctrl[index] = h;
+	if (index < CSTR_MAP_GROUP)
+		map->_ctrl[map->_capacity + index] = h;
 }
 
-size_t
-cstr_find_first_not_of_string
-(string_t string, const string_t find_str, size_t pos)
+bool
+_cstr_map_key_equal
+(string_t key, const char *string, size_t len)
 {
-	return cstr_find_first_not_of(string, cstr_data(find_str), pos);
+	return ((key == string) || ((_cstr_get_size(key) == len) && (memcmp(key, string, len) == 0)));
 }
 
 size_t
-cstr_find_first_not_of_char
-(string_t string, char c, size_t pos)
+_cstr_map_lookup
+(const cstr_map_t *map, const char *string, size_t len, uint64_t hash)
 {
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+	size_t mask = map->_capacity - 1;
+	size_t pos = (size_t)(hash >> 7) & mask;
+	int8_t h2 = (int8_t)(hash & 0x7F);
 
-	for (size_t i = pos; i < cstr_size(string); ++i)
-		if (string[i] != c) return i;
+	for (size_t step = CSTR_MAP_GROUP; ; step += CSTR_MAP_GROUP) {
+		const int8_t *group = map->_ctrl + pos;
 
-	return cstr_max_size(string);
+		for (uint32_t match = _cstr_map_match(group, h2); match; match &= match - 1) {
+			size_t index = (pos + _cstr_map_first(match)) & mask;
+			if (_cstr_map_key_equal(map->_slots[index]._key, string, len))
+				return index;
+		}
+
+		if (_cstr_map_match_empty(group))
+			return CSTR_NPOS;
+
+		pos = (pos + step) & mask;
+	}
 }
 
 size_t
-cstr_find_last_not_of
-(string_t string, const char *find_str, size_t pos)
+_cstr_map_find_free
+(const cstr_map_t *map, uint64_t hash)
 {
-	assert(find_str && "find_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+	size_t mask = map->_capacity - 1;
+	size_t pos = (size_t)(hash >> 7) & mask;
 
-	for (size_t i = cstr_size(string) - 1; i >= pos; --i) {
-		char *current = strchr(find_str, string[i]);
+	for (size_t step = CSTR_MAP_GROUP; ; step += CSTR_MAP_GROUP) {
+		uint32_t match = _cstr_map_match_free(map->_ctrl + pos);
+		if (match)
+			return ((pos + _cstr_map_first(match)) & mask);
 
-		if (!current)
-			return i;
+		pos = (pos + step) & mask;
 	}
-
-	return cstr_max_size(string);
 }
 
-size_t
-cstr_find_last_not_of_n
-(string_t string, const char *find_str, size_t pos, size_t n)
+void
+_cstr_map_resize
+(cstr_map_t *map, size_t capacity)
 {
-	assert(find_str && "find_str argument must be valid!");
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+	int8_t *old_ctrl = map->_ctrl;
+	cstr_map_slot_t *old_slots = map->_slots;
+	size_t old_capacity = map->_capacity;
 
-	char *actual_find_str = strdup(find_str);
-	actual_find_str[n] = '\0';
+	_cstr_map_alloc_table(map, capacity);
 
-	for (size_t i = cstr_size(string) - 1; i >= pos; --i) {
-		char *current = strchr(actual_find_str, string[i]);
+	for (size_t i = 0; i < old_capacity; ++i) {
+		if (old_ctrl[i] < 0)
+			continue;
 
-		if (!current) {
-			free(actual_find_str);
-			return i;
-		}
-	}
+		uint64_t hash = cstr_hash(old_slots[i]._key, map->_seed);
+		size_t index = _cstr_map_find_free(map, hash);
 
-	free(actual_find_str);
-	return cstr_max_size(string);
-}
+		_cstr_map_set_ctrl(map, index, (int8_t)(hash & 0x7F));
+		map->_slots[index] = old_slots[i];
+	}
 
-size_t
-cstr_find_last_not_of_string
-(string_t string, const string_t find_str, size_t pos)
-{
-	return cstr_find_last_not_of(string, cstr_data(find_str), pos);
+	map->_allocator->free(map->_allocator->context, old_ctrl, _cstr_map_table_size(old_capacity));
 }
 
-size_t
-cstr_find_last_not_of_char
-(string_t string, char c, size_t pos)
+string_t
+_cstr_map_own_key
+(string_t key)
 {
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
-
-	for (size_t i = cstr_size(string) - 1; i >= pos; --i)
-		if (string[i] != c) return i;
+	if (!(_cstr_flags(key) & CSTR_FLAG_SHARED))
+		return _cstr_shared_copy(key, _cstr_get_size(key), _cstr_global_allocator);
 
-	return cstr_max_size(string);
+	return cstr_share(cstr_retain(key));
 }
 
-string_t
-cstr_substr
-(string_t string, size_t pos, size_t len)
+bool
+_cstr_map_erase_at
+(cstr_map_t *map, size_t index)
 {
-	assert((pos <= cstr_size(string)) && "'pos' argument is out of range!");
+	if (index == CSTR_NPOS)
+		return false;
 
-	char *actual_string = strdup(string + pos);
-	actual_string[len] = '\0';
+	if (map->_owns_keys)
+		cstr_release(map->_slots[index]._key);
 
-	string_t substr = cstr_new(actual_string);
+	_cstr_map_set_ctrl(map, index, CSTR_MAP_DELETED);
+	--map->_count;
 
-	free(actual_string);
-	return substr;
+	return true;
 }
 
-int
-cstr_compare
-(string_t string, const char *compare_str)
-{	
-	assert(compare_str && "compare_str argument must be valid!");
-
-	return strcmp(cstr_data(string), compare_str);
-}
 
-int
-cstr_compare_ext
-(string_t string, size_t pos, size_t len, const char *compare_str)
+cstr_map_t *
+cstr_map_new
+(size_t capacity, bool owns_keys, uint64_t seed)
 {
-	assert(compare_str && "compare_str argument must be valid!");
+	const cstr_allocator_t *allocator = _cstr_global_allocator;
 
-	return strncmp(cstr_data(string) + pos, compare_str, len);
-}
+	cstr_map_t *map = allocator->alloc(allocator->context, sizeof(cstr_map_t));
+	assert(map && "failed to allocate map!");
 
-int
-cstr_compare_n
-(string_t string, const char *compare_str, size_t n)
-{
-	assert(compare_str && "compare_str argument must be valid!");
+	size_t table_capacity = CSTR_MAP_MIN_CAPACITY;
+	while (_cstr_map_max_load(table_capacity) < capacity)
+		table_capacity <<= 1;
 
-	char *actual_compare_str = strdup(compare_str);
-	actual_compare_str[n] = '\0';
+	map->_allocator = allocator;
+	map->_count = 0;
+	map->_seed = seed;
+	map->_owns_keys = owns_keys;
 
-	int res = strcmp(cstr_data(string), actual_compare_str);
+	_cstr_map_alloc_table(map, table_capacity);
 
-	free(actual_compare_str);
-	return res;
+	return map;
 }
 
-int
-cstr_compare_n_ext
-(string_t string, size_t pos, size_t len, const char *compare_str, size_t n)
+void
+cstr_map_destroy
+(cstr_map_t *map)
 {
-	assert(compare_str && "compare_str argument must be valid!");
-
-	char *actual_compare_str = strdup(compare_str);
-	actual_compare_str[n] = '\0';
+	if (!map)
+		return;
 
-	int res = strncmp(cstr_data(string) + pos, actual_compare_str, len);
+	cstr_map_clear(map);
 
-	free(actual_compare_str);
-	return res;
+	const cstr_allocator_t *allocator = map->_allocator;
+	allocator->free(allocator->context, map->_ctrl, _cstr_map_table_size(map->_capacity));
+	allocator->free(allocator->context, map, sizeof(cstr_map_t));
 }
 
-int
-cstr_compare_string
-(string_t string, const string_t compare_str)
+void
+cstr_map_clear
+(cstr_map_t *map)
 {
-	return cstr_compare(string, cstr_data(compare_str));
+	if (map->_owns_keys) {
+		for (size_t i = 0; i < map->_capacity; ++i) {
+			if (map->_ctrl[i] >= 0)
+				cstr_release(map->_slots[i]._key);
+		}
+	}
+
+	memset(map->_ctrl, (uint8_t)CSTR_MAP_EMPTY, map->_capacity + CSTR_MAP_GROUP);
+	map->_count = 0;
+	map->_growth_left = _cstr_map_max_load(map->_capacity);
 }
 
-int
-cstr_compare_string_ext
-(string_t string, size_t pos, size_t len, const string_t compare_str)
+size_t
+cstr_map_size
+(const cstr_map_t *map)
 {
-	return cstr_compare_ext(string, pos, len, cstr_data(compare_str));
+	return map->_count;
 }
 
-int
-cstr_compare_substring
-(string_t string, const string_t compare_str, size_t subpos, size_t sublen)
+bool
+cstr_map_insert
+(cstr_map_t *map, string_t key, void *value)
 {
-	assert(compare_str && "compare_str argument must be valid!");
+	assert(key && "key argument must be valid!");
 
-	size_t length = cstr_length(compare_str);
-	if (subpos < length) {
-		size_t actual_sublen = ((sublen > (length - subpos)) ? (length - subpos) : sublen);
-		return cstr_compare_n(string, cstr_data(compare_str) + subpos, actual_sublen);
+	uint64_t hash = cstr_hash(key, map->_seed);
+
+	size_t index = _cstr_map_lookup(map, key, _cstr_get_size(key), hash);
+	if (index != CSTR_NPOS) {
+		map->_slots[index]._value = value;
+		return false;
 	}
 
-	return cstr_max_size(string);
-}
+	index = _cstr_map_find_free(map, hash);
 
-int
-cstr_compare_substring_ext
-(string_t string, size_t pos, size_t len, const string_t compare_str, size_t subpos, size_t sublen)
-{
-	assert(compare_str && "compare_str argument must be valid!");
+	if ((map->_growth_left == 0) && (map->_ctrl[index] == CSTR_MAP_EMPTY)) {
+		size_t capacity = map->_capacity;
+		if (map->_count * 16 > capacity * 7)
+			capacity <<= 1;
 
-	size_t length = cstr_length(compare_str);
-	if (subpos < length) {
-		size_t actual_sublen = ((sublen > (length - subpos)) ? (length - subpos) : sublen);
-		return cstr_compare_n_ext(string, pos, len, cstr_data(compare_str) + subpos, actual_sublen);
+		_cstr_map_resize(map, capacity);
+		index = _cstr_map_find_free(map, hash);
 	}
 
-	return cstr_max_size(string);
-}
+	if (map->_ctrl[index] == CSTR_MAP_EMPTY)
+		--map->_growth_left;
 
+	_cstr_map_set_ctrl(map, index, (int8_t)(hash & 0x7F));
+	map->_slots[index]._key = map->_owns_keys ? _cstr_map_own_key(key) : key;
+	map->_slots[index]._value = value;
+	++map->_count;
 
-size_t
-cstr_size
-(string_t string)
-{
-	return (_cstr_header(string)->_size);
+	return true;
 }
 
-size_t
-cstr_length
-(string_t string)
+bool
+cstr_map_find
+(const cstr_map_t *map, string_t key, void **value)
 {
-	return (_cstr_header(string)->_size);
-}
+	assert(key && "key argument must be valid!");
 
-size_t
-cstr_max_size
-(string_t string)
-{
-	return SIZE_MAX;
-}
+	size_t index = _cstr_map_lookup(map, key, _cstr_get_size(key), cstr_hash(key, map->_seed));
+	if (index == CSTR_NPOS)
+		return false;
 
-size_t
-cstr_capacity
-(string_t string)
-{
-	return (_cstr_header(string)->_capacity);
-}
+	if (value)
+		*value = map->_slots[index]._value;
 
-void *
-cstr_begin
-(string_t string)
-{
-	return (_cstr_header(string)->_begin);
+	return true;
 }
 
-void *
-cstr_end
-(string_t string)
+bool
+cstr_map_find_n
+(const cstr_map_t *map, const char *key, size_t len, void **value)
 {
-	return (_cstr_header(string)->_end);
+	assert((key || (len == 0)) && "key argument must be valid!");
+
+	if (!key)
+		key = "";
+
+	size_t index = _cstr_map_lookup(map, key, len, _cstr_hash_bytes(key, len, map->_seed));
+	if (index == CSTR_NPOS)
+		return false;
+
+	if (value)
+		*value = map->_slots[index]._value;
+
+	return true;
 }
 
 bool
-cstr_empty
-(string_t string)
+cstr_map_contains
+(const cstr_map_t *map, string_t key)
 {
-	return ((_cstr_header(string)->_size) == 0);
+	return cstr_map_find(map, key, NULL);
 }
 
-char
-cstr_at
-(string_t string, const size_t pos)
+bool
+cstr_map_erase
+(cstr_map_t *map, string_t key)
 {
-	assert(
-		(pos < _cstr_header(string)->_size) &&
-		"attempted to access element at out of bound position!"
-	);
+	assert(key && "key argument must be valid!");
 
-	return (string[pos]);
+	return _cstr_map_erase_at(map, _cstr_map_lookup(map, key, _cstr_get_size(key), cstr_hash(key, map->_seed)));
 }
 
-char
-cstr_front
-(string_t string)
+bool
+cstr_map_erase_n
+(cstr_map_t *map, const char *key, size_t len)
 {
-	return (*(char *)cstr_begin(string));
-}
+	assert((key || (len == 0)) && "key argument must be valid!");
 
-char
-cstr_back
-(string_t string)
-{
-	return (*(char *)cstr_end(string));
+	if (!key)
+		key = "";
+
+	return _cstr_map_erase_at(map, _cstr_map_lookup(map, key, len, _cstr_hash_bytes(key, len, map->_seed)));
 }
 
-char *
-cstr_data
-(string_t string)
+bool
+cstr_map_next
+(const cstr_map_t *map, size_t *cursor, string_t *key, void **value)
 {
-	return (char *)(cstr_begin(string));
-}
+	assert(cursor && "cursor argument must be valid!");
 
+	for (size_t i = *cursor; i < map->_capacity; ++i) {
+		if (map->_ctrl[i] < 0)
+			continue;
 
+		if (key)
+			*key = map->_slots[i]._key;
+		if (value)
+			*value = map->_slots[i]._value;
+
+		*cursor = i + 1;
+		return true;
+	}
+
+	*cursor = map->_capacity;
+	return false;
+}
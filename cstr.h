@@ -8,24 +8,284 @@
 #include <stdlib.h>
 #endif
 
+#include <stdint.h>
+#include <stdarg.h>
+
 
 typedef	char *	string_t;
 
+#define	CSTR_NPOS	((size_t)-1)
+
+#define	CSTR_BUFFER(array)	cstr_init_buffer((array), sizeof(array))
+
+#define	CSTR_LITERAL_FLAGS	0x22
+
+#if	defined(__GNUC__)
+#	define	CSTR_FORMAT(format_index, args_index)	__attribute__((format(printf, format_index, args_index)))
+#else
+#	define	CSTR_FORMAT(format_index, args_index)
+#endif
+
+#define	CSTR_LITERAL_TYPE(literal)				\
+	struct {									\
+		uint32_t	_size;						\
+		uint32_t	_capacity;					\
+		uint8_t		_flags;						\
+		char		_data[sizeof(literal)];		\
+	}
+
+#define	CSTR_LITERAL_INIT(literal)				\
+	{ sizeof(literal) - 1, sizeof(literal) - 1, CSTR_LITERAL_FLAGS, literal }
+
+#if	defined(__GNUC__)
+#	define	CSTR_LIT(literal)					\
+	(__extension__ ({							\
+		static const CSTR_LITERAL_TYPE(literal) _cstr_literal = CSTR_LITERAL_INIT(literal);	\
+		(string_t)_cstr_literal._data;			\
+	}))
+#else
+#	define	CSTR_LIT(literal)					\
+	((string_t)((CSTR_LITERAL_TYPE(literal))CSTR_LITERAL_INIT(literal))._data)
+#endif
+
+typedef struct cstr_allocator_t
+{
+	void *	(*alloc)	(void *context, size_t size);
+	void *	(*realloc)	(void *context, void *ptr, size_t old_size, size_t new_size);
+	void	(*free)		(void *context, void *ptr, size_t size);
+
+	void *	context;
+
+	size_t	(*usable_size)	(void *context, void *ptr, size_t size);
+}
+cstr_allocator_t;
+
+typedef struct cstr_policy_t
+{
+	double	growth_factor;
+	size_t	page_threshold;
+	size_t	page_size;
+	bool	harvest_slack;
+	double	shrink_ratio;
+
+	size_t	mmap_threshold;
+	bool	huge_pages;
+}
+cstr_policy_t;
+
+typedef struct cstr_charset_t
+{
+	uint8_t	_bitmap[32];
+	uint8_t	_low[16];
+	uint8_t	_high[16];
+}
+cstr_charset_t;
+
+typedef struct cstr_view_t
+{
+	const char *	ptr;
+	size_t			len;
+}
+cstr_view_t;
+
+typedef struct cstr_edit_t
+{
+	size_t			pos;
+	size_t			len;
+	const char *	replace_str;
+	size_t			replace_len;
+}
+cstr_edit_t;
+
+typedef enum cstr_match_mode_t
+{
+	CSTR_MATCH_DISJOINT,
+	CSTR_MATCH_OVERLAP
+}
+cstr_match_mode_t;
+
+typedef struct cstr_match_iter_t
+{
+	string_t		_string;
+	const char *	_needle;
+	size_t			_len;
+	size_t			_step;
+	size_t			_pos;
+}
+cstr_match_iter_t;
+
+typedef struct cstr_rope_t cstr_rope_t;
+
+typedef struct cstr_rope_node_t cstr_rope_node_t;
+
+#define	CSTR_ROPE_MAX_DEPTH	96
+
+typedef struct cstr_rope_iter_t
+{
+	const cstr_rope_node_t *	_stack[CSTR_ROPE_MAX_DEPTH];
+	size_t						_depth;
+	size_t						_offset;
+}
+cstr_rope_iter_t;
+
+typedef struct cstr_gap_t cstr_gap_t;
+
+typedef struct cstr_intern_stats_t
+{
+	size_t	hits;
+	size_t	misses;
+	double	hit_rate;
+	size_t	entries;
+	size_t	bytes_stored;
+	size_t	bytes_saved;
+	size_t	evictions;
+}
+cstr_intern_stats_t;
+
+typedef struct cstr_map_t cstr_map_t;
+
+typedef struct cstr_searcher_t cstr_searcher_t;
+
+typedef struct cstr_multimatcher_t cstr_multimatcher_t;
+
+typedef bool (*cstr_match_fn_t)(void *context, size_t id, size_t pos);
+
+typedef struct cstr_arena_t cstr_arena_t;
+
+typedef struct cstr_arena_mark_t
+{
+	void *	_chunk;
+	size_t	_offset;
+}
+cstr_arena_mark_t;
+
+
+void
+cstr_set_allocator
+(const cstr_allocator_t *allocator);
+
+const cstr_allocator_t *
+cstr_get_allocator
+(void);
+
+const cstr_allocator_t *
+cstr_allocator
+(string_t string);
+
+
+void
+cstr_set_policy
+(const cstr_policy_t *policy);
+
+cstr_policy_t
+cstr_get_policy
+(void);
+
+
+cstr_arena_t *
+cstr_arena_new
+(size_t chunk_size);
+
+void
+cstr_arena_destroy
+(cstr_arena_t *arena);
+
+void
+cstr_arena_reset
+(cstr_arena_t *arena);
+
+cstr_arena_mark_t
+cstr_arena_mark
+(cstr_arena_t *arena);
+
+void
+cstr_arena_rollback
+(cstr_arena_t *arena, cstr_arena_mark_t mark);
+
+const cstr_allocator_t *
+cstr_arena_allocator
+(cstr_arena_t *arena);
+
+string_t
+cstr_arena_string
+(cstr_arena_t *arena, const char *string);
+
+
+#if	defined(CSTR_POOL)
+
+void
+cstr_pool_set_high_water
+(size_t bytes);
+
+size_t
+cstr_pool_cached
+(void);
+
+void
+cstr_pool_thread_flush
+(void);
+
+void
+cstr_pool_trim
+(void);
+
+#endif
+
 
 string_t
 cstr_new
 (const char *string);
 
+string_t
+cstr_new_with
+(const char *string, const cstr_allocator_t *allocator);
+
 string_t
 cstr_reserve
 (const size_t capacity);
 
+string_t
+cstr_reserve_with
+(const size_t capacity, const cstr_allocator_t *allocator);
+
+string_t
+cstr_reserve_string
+(string_t string, size_t capacity);
+
+string_t
+cstr_init_buffer
+(void *buffer, size_t buffer_size);
+
+bool
+cstr_is_buffered
+(string_t string);
+
+bool
+cstr_is_immutable
+(string_t string);
+
 void
 cstr_destroy
 (string_t string);
 
+string_t
+cstr_retain
+(string_t string);
 
 void
+cstr_release
+(string_t string);
+
+string_t
+cstr_share
+(string_t string);
+
+bool
+cstr_is_shared
+(string_t string);
+
+
+string_t
 cstr_clear
 (string_t string);
 
@@ -33,7 +293,7 @@ string_t
 cstr_shrink_to_fit
 (string_t string);
 
-void
+string_t
 cstr_resize
 (string_t string, size_t n, char c);
 
@@ -57,15 +317,23 @@ string_t
 cstr_append_range
 (string_t string, const void *start, const void *end);
 
+string_t
+cstr_append_vfmt
+(string_t string, const char *format, va_list args) CSTR_FORMAT(2, 0);
+
+string_t
+cstr_append_fmt
+(string_t string, const char *format, ...) CSTR_FORMAT(2, 3);
+
 string_t
 cstr_append_fill
 (string_t string, size_t n, char c);
 
-void
+string_t
 cstr_push_back
 (string_t string, char c);
 
-void
+string_t
 cstr_pop_back
 (string_t string);
 
@@ -149,6 +417,22 @@ string_t
 cstr_replace_range
 (string_t string, size_t pos, size_t len, const void *start, const void *end);
 
+string_t
+cstr_replace_all
+(string_t string, const char *find_str, const char *replace_str);
+
+string_t
+cstr_replace_all_n
+(string_t string, const char *find_str, size_t find_len, const char *replace_str, size_t replace_len);
+
+string_t
+cstr_replace_all_string
+(string_t string, const string_t find_str, const string_t replace_str);
+
+string_t
+cstr_edit_batch
+(string_t string, cstr_edit_t *edits, size_t count);
+
 void
 cstr_swap
 (string_t *left, string_t *right);
@@ -185,6 +469,34 @@ size_t
 cstr_rfind_string
 (string_t string, const string_t find_str, size_t pos);
 
+size_t
+cstr_find_all
+(string_t string, const char *find_str, size_t *positions, size_t cap);
+
+size_t
+cstr_find_all_n
+(string_t string, const char *find_str, size_t n, size_t *positions, size_t cap, cstr_match_mode_t mode);
+
+size_t
+cstr_count
+(string_t string, const char *find_str);
+
+size_t
+cstr_count_n
+(string_t string, const char *find_str, size_t n, cstr_match_mode_t mode);
+
+size_t
+cstr_count_char
+(string_t string, char c);
+
+void
+cstr_match_iter_init
+(cstr_match_iter_t *iter, string_t string, const char *find_str, size_t n, cstr_match_mode_t mode);
+
+size_t
+cstr_match_next
+(cstr_match_iter_t *iter);
+
 size_t
 cstr_rfind_char
 (string_t string, char c, size_t pos);
@@ -201,6 +513,10 @@ size_t
 cstr_find_first_of_string
 (string_t string, const string_t find_str, size_t pos);
 
+size_t
+cstr_find_first_of_charset
+(string_t string, const cstr_charset_t *charset, size_t pos);
+
 size_t
 cstr_find_first_of_char
 (string_t string, char c, size_t pos);
@@ -217,6 +533,10 @@ size_t
 cstr_find_last_of_string
 (string_t string, const string_t find_str, size_t pos);
 
+size_t
+cstr_find_last_of_charset
+(string_t string, const cstr_charset_t *charset, size_t pos);
+
 size_t
 cstr_find_last_of_char
 (string_t string, char c, size_t pos);
@@ -233,6 +553,10 @@ size_t
 cstr_find_first_not_of_string
 (string_t string, const string_t find_str, size_t pos);
 
+size_t
+cstr_find_first_not_of_charset
+(string_t string, const cstr_charset_t *charset, size_t pos);
+
 size_t
 cstr_find_first_not_of_char
 (string_t string, char c, size_t pos);
@@ -249,6 +573,10 @@ size_t
 cstr_find_last_not_of_string
 (string_t string, const string_t find_str, size_t pos);
 
+size_t
+cstr_find_last_not_of_charset
+(string_t string, const cstr_charset_t *charset, size_t pos);
+
 size_t
 cstr_find_last_not_of_char
 (string_t string, char c, size_t pos);
@@ -290,6 +618,75 @@ cstr_compare_substring_ext
 (string_t string, size_t pos, size_t len, const string_t compare_str, size_t subpos, size_t sublen);
 
 
+cstr_view_t
+cstr_view
+(string_t string, size_t pos, size_t len);
+
+cstr_view_t
+cstr_view_of
+(const char *ptr, size_t len);
+
+cstr_view_t
+cstr_view_sub
+(cstr_view_t view, size_t pos, size_t len);
+
+string_t
+cstr_new_view
+(cstr_view_t view);
+
+size_t
+cstr_view_find
+(cstr_view_t view, cstr_view_t find_view, size_t pos);
+
+size_t
+cstr_view_rfind
+(cstr_view_t view, cstr_view_t find_view, size_t pos);
+
+int
+cstr_view_compare
+(cstr_view_t left, cstr_view_t right);
+
+size_t
+cstr_find_view
+(string_t string, cstr_view_t find_view, size_t pos);
+
+size_t
+cstr_rfind_view
+(string_t string, cstr_view_t find_view, size_t pos);
+
+size_t
+cstr_find_first_of_view
+(string_t string, cstr_view_t find_view, size_t pos);
+
+size_t
+cstr_find_last_of_view
+(string_t string, cstr_view_t find_view, size_t pos);
+
+size_t
+cstr_find_first_not_of_view
+(string_t string, cstr_view_t find_view, size_t pos);
+
+size_t
+cstr_find_last_not_of_view
+(string_t string, cstr_view_t find_view, size_t pos);
+
+int
+cstr_compare_view
+(string_t string, cstr_view_t compare_view);
+
+string_t
+cstr_append_view
+(string_t string, cstr_view_t append_view);
+
+string_t
+cstr_insert_view
+(string_t string, size_t pos, cstr_view_t insert_view);
+
+string_t
+cstr_replace_view
+(string_t string, size_t pos, size_t len, cstr_view_t replace_view);
+
+
 size_t
 cstr_size
 (string_t string);
@@ -335,5 +732,270 @@ cstr_data
 (string_t string);
 
 
+void
+cstr_charset_init
+(cstr_charset_t *charset, const char *set, size_t len);
+
+void
+cstr_charset_add
+(cstr_charset_t *charset, char c);
+
+bool
+cstr_charset_contains
+(const cstr_charset_t *charset, char c);
+
+
+cstr_searcher_t *
+cstr_searcher_new
+(const char *needle, size_t len);
+
+void
+cstr_searcher_destroy
+(cstr_searcher_t *searcher);
+
+size_t
+cstr_find_with
+(const cstr_searcher_t *searcher, string_t string, size_t pos);
+
+size_t
+cstr_rfind_with
+(const cstr_searcher_t *searcher, string_t string, size_t pos);
+
+
+cstr_multimatcher_t *
+cstr_multimatcher_new
+(const char *const *patterns, const size_t *lens, size_t count);
+
+void
+cstr_multimatcher_destroy
+(cstr_multimatcher_t *matcher);
+
+size_t
+cstr_multimatcher_find
+(const cstr_multimatcher_t *matcher, string_t string, size_t pos, size_t *id);
+
+size_t
+cstr_multimatcher_find_all
+(const cstr_multimatcher_t *matcher, string_t string, size_t pos, cstr_match_fn_t callback, void *context);
+
+bool
+cstr_multimatcher_matches
+(const cstr_multimatcher_t *matcher, string_t string, size_t pos);
+
+
+cstr_rope_t *
+cstr_rope_new
+(const char *string, size_t len);
+
+cstr_rope_t *
+cstr_rope_from_string
+(string_t string);
+
+cstr_rope_t *
+cstr_rope_clone
+(const cstr_rope_t *rope);
+
+void
+cstr_rope_destroy
+(cstr_rope_t *rope);
+
+size_t
+cstr_rope_length
+(const cstr_rope_t *rope);
+
+char
+cstr_rope_at
+(const cstr_rope_t *rope, size_t pos);
+
+void
+cstr_rope_insert
+(cstr_rope_t *rope, size_t pos, const char *string, size_t len);
+
+void
+cstr_rope_insert_rope
+(cstr_rope_t *rope, size_t pos, const cstr_rope_t *other);
+
+void
+cstr_rope_append
+(cstr_rope_t *rope, const char *string, size_t len);
+
+void
+cstr_rope_concat
+(cstr_rope_t *rope, const cstr_rope_t *other);
+
+void
+cstr_rope_erase
+(cstr_rope_t *rope, size_t pos, size_t len);
+
+cstr_rope_t *
+cstr_rope_split
+(cstr_rope_t *rope, size_t pos);
 
+cstr_rope_t *
+cstr_rope_substr
+(const cstr_rope_t *rope, size_t pos, size_t len);
 
+void
+cstr_rope_iter_init
+(cstr_rope_iter_t *iter, const cstr_rope_t *rope, size_t pos);
+
+bool
+cstr_rope_iter_next
+(cstr_rope_iter_t *iter, const char **chunk, size_t *len);
+
+string_t
+cstr_rope_flatten
+(const cstr_rope_t *rope);
+
+size_t
+cstr_rope_find
+(const cstr_rope_t *rope, const char *find_str, size_t pos, size_t n);
+
+
+cstr_gap_t *
+cstr_gap_new
+(const char *string, size_t len);
+
+cstr_gap_t *
+cstr_gap_from_string
+(string_t string);
+
+void
+cstr_gap_destroy
+(cstr_gap_t *gap);
+
+size_t
+cstr_gap_length
+(const cstr_gap_t *gap);
+
+size_t
+cstr_gap_cursor
+(const cstr_gap_t *gap);
+
+char
+cstr_gap_at
+(const cstr_gap_t *gap, size_t pos);
+
+void
+cstr_gap_move
+(cstr_gap_t *gap, size_t pos);
+
+void
+cstr_gap_insert
+(cstr_gap_t *gap, const char *string, size_t len);
+
+void
+cstr_gap_erase
+(cstr_gap_t *gap, size_t len);
+
+void
+cstr_gap_backspace
+(cstr_gap_t *gap, size_t len);
+
+string_t
+cstr_gap_materialize
+(const cstr_gap_t *gap);
+
+size_t
+cstr_gap_find
+(const cstr_gap_t *gap, const char *find_str, size_t pos, size_t n);
+
+int
+cstr_gap_compare
+(const cstr_gap_t *gap, const char *compare_str, size_t n);
+
+int
+cstr_gap_compare_string
+(const cstr_gap_t *gap, const string_t compare_str);
+
+
+/* the hash is cached only on shared strings (see cstr_share); other strings are rehashed on every call */
+uint64_t
+cstr_hash
+(string_t string, uint64_t seed);
+
+uint64_t
+cstr_hash_n
+(const char *string, size_t len, uint64_t seed);
+
+void
+cstr_hash_many
+(const string_t *strings, size_t count, uint64_t seed, uint64_t *hashes);
+
+void
+cstr_hash_invalidate
+(string_t string);
+
+
+string_t
+cstr_intern
+(const char *string, size_t len);
+
+string_t
+cstr_intern_string
+(string_t string);
+
+bool
+cstr_is_interned
+(string_t string);
+
+void
+cstr_intern_set_max_age
+(size_t epochs);
+
+size_t
+cstr_intern_advance_epoch
+(void);
+
+void
+cstr_intern_stats
+(cstr_intern_stats_t *stats);
+
+void
+cstr_intern_reset
+(void);
+
+
+cstr_map_t *
+cstr_map_new
+(size_t capacity, bool owns_keys, uint64_t seed);
+
+void
+cstr_map_destroy
+(cstr_map_t *map);
+
+void
+cstr_map_clear
+(cstr_map_t *map);
+
+size_t
+cstr_map_size
+(const cstr_map_t *map);
+
+bool
+cstr_map_insert
+(cstr_map_t *map, string_t key, void *value);
+
+bool
+cstr_map_find
+(const cstr_map_t *map, string_t key, void **value);
+
+bool
+cstr_map_find_n
+(const cstr_map_t *map, const char *key, size_t len, void **value);
+
+bool
+cstr_map_contains
+(const cstr_map_t *map, string_t key);
+
+bool
+cstr_map_erase
+(cstr_map_t *map, string_t key);
+
+bool
+cstr_map_erase_n
+(cstr_map_t *map, const char *key, size_t len);
+
+bool
+cstr_map_next
+(const cstr_map_t *map, size_t *cursor, string_t *key, void **value);
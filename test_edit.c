@@ -0,0 +1,146 @@
+#include "cstr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define EDITS	200
+
+
+bool before(const cstr_edit_t *left, const cstr_edit_t *right)
+{
+	if (left->pos != right->pos)
+		return (left->pos < right->pos);
+
+	return ((left->len == 0) && (right->len != 0));
+}
+
+char *apply(const char *text, const cstr_edit_t *edits, size_t count)
+{
+	cstr_edit_t *sorted = malloc(count * sizeof(cstr_edit_t));
+	memcpy(sorted, edits, count * sizeof(cstr_edit_t));
+
+	for (size_t i = 1; i < count; ++i)
+		for (size_t j = i; (j > 0) && before(&sorted[j], &sorted[j - 1]); --j) {
+			cstr_edit_t edit = sorted[j];
+			sorted[j] = sorted[j - 1];
+			sorted[j - 1] = edit;
+		}
+
+	size_t size = strlen(text), total = size;
+	for (size_t i = 0; i < count; ++i)
+		total += sorted[i].replace_len;
+
+	char *result = malloc(total + 1);
+	size_t read = 0, write = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		memcpy(result + write, text + read, sorted[i].pos - read);
+		write += sorted[i].pos - read;
+
+		memcpy(result + write, sorted[i].replace_str, sorted[i].replace_len);
+		write += sorted[i].replace_len;
+
+		read = sorted[i].pos + sorted[i].len;
+	}
+
+	memcpy(result + write, text + read, size - read);
+	result[write + size - read] = '\0';
+
+	free(sorted);
+	return result;
+}
+
+void shuffle(cstr_edit_t *edits, size_t count)
+{
+	for (size_t i = count; i > 1; --i) {
+		size_t j = (size_t)rand() % i;
+		cstr_edit_t edit = edits[i - 1];
+		edits[i - 1] = edits[j];
+		edits[j] = edit;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	static char labels[EDITS][8];
+	static cstr_edit_t edits[EDITS];
+
+	for (size_t i = 0; i < EDITS; ++i)
+		snprintf(labels[i], sizeof(labels[i]), "<%zu>", i);
+
+	srand(3);
+
+	for (size_t round = 0; round < 50; ++round) {
+		string_t s = cstr_new("");
+		for (size_t i = 0; i < 40; ++i)
+			s = cstr_append(s, "0123456789");
+
+		size_t size = cstr_size(s), count = 0, pos = 0;
+
+		while ((count < EDITS) && (pos < size)) {
+			if (rand() % 2) {
+				edits[count] = (cstr_edit_t){ pos, 0, labels[count], strlen(labels[count]) };
+				++count;
+				continue;
+			}
+
+			size_t len = (size_t)rand() % 4;
+			if (len > size - pos)
+				len = size - pos;
+
+			size_t replace_len = (size_t)rand() % 5;
+			edits[count] = (cstr_edit_t){ pos, len, labels[count], (replace_len < strlen(labels[count])) ? replace_len : strlen(labels[count]) };
+			++count;
+
+			pos += len + (size_t)rand() % 6;
+		}
+
+		assert(count > 16);
+
+		shuffle(edits, count);
+		char *expected = apply(s, edits, count);
+
+		s = cstr_edit_batch(s, edits, count);
+		assert(strcmp(s, expected) == 0);
+
+		free(expected);
+		cstr_destroy(s);
+	}
+
+	string_t s = cstr_new("abcdef");
+	cstr_edit_t ties[] = {
+		{ 3, 1, "X", 1 },
+		{ 3, 0, "1", 1 },
+		{ 0, 0, "[", 1 },
+		{ 3, 0, "2", 1 },
+		{ 3, 0, "3", 1 },
+	};
+	s = cstr_edit_batch(s, ties, sizeof(ties) / sizeof(ties[0]));
+	assert(strcmp(s, "[abc123Xef") == 0);
+	cstr_destroy(s);
+
+	s = cstr_new("");
+	while (cstr_size(s) < 40)
+		s = cstr_append(s, "alias-");
+
+	char *original = strdup(s);
+	cstr_edit_t aliased[20];
+	for (size_t i = 0; i < 20; ++i)
+		aliased[i] = (cstr_edit_t){ (19 - i) * 2, 0, s + i, 20 };
+
+	char *expected = apply(original, aliased, 20);
+	for (size_t i = 0; i < 20; ++i)
+		aliased[i].replace_str = s + i;
+
+	s = cstr_edit_batch(s, aliased, 20);
+	assert(strcmp(s, expected) == 0);
+
+	free(expected);
+	free(original);
+	cstr_destroy(s);
+
+	printf("edit batch tests passed\n");
+	return 0;
+}
@@ -0,0 +1,56 @@
+#include "cstr.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <assert.h>
+
+
+int main(int argc, char **argv)
+{
+	char expected[1024];
+
+	string_t s = cstr_new("x");
+	for (size_t i = 0; i < 5; ++i) {
+		snprintf(expected, sizeof(expected), "%s[%s|%s]", s, s, s + 1);
+		s = cstr_append_fmt(s, "[%s|%s]", s, s + 1);
+		assert(strcmp(s, expected) == 0);
+	}
+	cstr_destroy(s);
+
+	s = cstr_new("abcdefghij");
+	snprintf(expected, sizeof(expected), "%s%.*s%*d", s, 4, s + 3, 6, 42);
+	s = cstr_append_fmt(s, "%.*s%*d", 4, s + 3, 6, 42);
+	assert(strcmp(s, expected) == 0);
+	cstr_destroy(s);
+
+	s = cstr_new("n=%d;");
+	s = cstr_append_fmt(s, s, 5);
+	assert(strcmp(s, "n=%d;n=5;") == 0);
+	cstr_destroy(s);
+
+	s = cstr_new("head:");
+	s = cstr_append_fmt(s, "%2$s/%1$s", "first", s);
+	assert(strcmp(s, "head:head:/first") == 0);
+	s = cstr_append_fmt(s, "%2$d%1$d", 1, 2);
+	assert(strcmp(s, "head:head:/first21") == 0);
+	cstr_destroy(s);
+
+	wchar_t bad[] = { (wchar_t)0x110000, 0 };
+	char probe[8];
+	if (snprintf(probe, sizeof(probe), "%ls", bad) < 0) {
+		s = cstr_new("keep");
+		s = cstr_append_fmt(s, "%d%ls", 7, bad);
+		assert((cstr_size(s) == 4) && (strcmp(s, "keep") == 0));
+
+		s = cstr_append_fmt(s, "%s%ls", s, bad);
+		assert((cstr_size(s) == 4) && (strcmp(s, "keep") == 0));
+
+		s = cstr_append_fmt(s, "%ls%s", bad, "!");
+		assert(strcmp(s, "keep") == 0);
+		cstr_destroy(s);
+	}
+
+	printf("format tests passed\n");
+	return 0;
+}
@@ -0,0 +1,103 @@
+#include "cstr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define MODEL_CAPACITY	(1 << 16)
+
+
+int main(int argc, char **argv)
+{
+	static char model[MODEL_CAPACITY];
+	size_t len = 5, cursor = 5;
+
+	memcpy(model, "hello", len);
+
+	srand(2);
+	cstr_gap_t *gap = cstr_gap_new("hello", 5);
+
+	for (size_t step = 0; step < 20000; ++step) {
+		switch (rand() % 4) {
+		case 0:
+			cursor = (size_t)rand() % (len + 1);
+			cstr_gap_move(gap, cursor);
+			break;
+
+		case 1: {
+			char text[8];
+			size_t n = (size_t)rand() % sizeof(text);
+			for (size_t i = 0; i < n; ++i)
+				text[i] = (char)('a' + rand() % 26);
+
+			if (len + n >= MODEL_CAPACITY)
+				break;
+
+			memmove(model + cursor + n, model + cursor, len - cursor);
+			memcpy(model + cursor, text, n);
+			len += n;
+			cursor += n;
+			cstr_gap_insert(gap, text, n);
+			break;
+		}
+
+		case 2: {
+			size_t n = (size_t)rand() % 4;
+			if (n > len - cursor)
+				n = len - cursor;
+
+			memmove(model + cursor, model + cursor + n, len - cursor - n);
+			len -= n;
+			cstr_gap_erase(gap, n);
+			break;
+		}
+
+		default: {
+			size_t n = (size_t)rand() % 4;
+			if (n > cursor)
+				n = cursor;
+
+			memmove(model + cursor - n, model + cursor, len - cursor);
+			len -= n;
+			cursor -= n;
+			cstr_gap_backspace(gap, n);
+			break;
+		}
+		}
+
+		assert(cstr_gap_length(gap) == len);
+		assert(cstr_gap_cursor(gap) == cursor);
+	}
+
+	for (size_t i = 0; i < len; ++i)
+		assert(cstr_gap_at(gap, i) == model[i]);
+
+	assert(cstr_gap_compare(gap, model, len) == 0);
+
+	if (len > 8)
+		assert(cstr_gap_find(gap, model + len - 8, 0, 8) <= len - 8);
+
+	string_t text = cstr_gap_materialize(gap);
+	assert((cstr_size(text) == len) && (memcmp(text, model, len) == 0));
+	assert(cstr_gap_compare_string(gap, text) == 0);
+
+	cstr_destroy(text);
+	cstr_gap_destroy(gap);
+
+	cstr_policy_t policy = cstr_get_policy();
+	cstr_policy_t slow = policy;
+	slow.growth_factor = 1.01;
+	cstr_set_policy(&slow);
+
+	memset(model, 'x', 199);
+	gap = cstr_gap_new(NULL, 0);
+	cstr_gap_insert(gap, model, 199);
+	assert((cstr_gap_length(gap) == 199) && (cstr_gap_compare(gap, model, 199) == 0));
+	cstr_gap_destroy(gap);
+
+	cstr_set_policy(&policy);
+
+	printf("gap buffer tests passed\n");
+	return 0;
+}
@@ -0,0 +1,74 @@
+#include "cstr.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+
+int main(int argc, char **argv)
+{
+	string_t a = cstr_intern("hello", 5);
+	string_t b = cstr_intern("hello", 5);
+	assert(a == b);
+	assert(cstr_is_interned(a));
+
+	cstr_destroy(a);
+	cstr_destroy(b);
+
+	string_t c = cstr_intern("hello", 5);
+	assert(strcmp(c, "hello") == 0);
+
+	string_t d = cstr_append(c, ", world");
+	assert(strcmp(d, "hello, world") == 0);
+	assert(!cstr_is_interned(d));
+	cstr_destroy(d);
+
+	string_t e = cstr_intern("hello", 5);
+	string_t f = cstr_intern_string(e);
+	assert(e == f);
+	cstr_destroy(f);
+
+	cstr_intern_set_max_age(1);
+
+	for (int i = 0; i < 4; ++i)
+		cstr_intern_advance_epoch();
+
+	cstr_intern_stats_t stats;
+	cstr_intern_stats(&stats);
+	assert(stats.entries == 0);
+	assert(stats.evictions == 1);
+
+	assert(strcmp(e, "hello") == 0);
+
+	string_t g = cstr_intern("hello", 5);
+	assert(g != e);
+	assert(strcmp(g, "hello") == 0);
+
+	cstr_destroy(e);
+	cstr_destroy(g);
+
+	cstr_intern_set_max_age(0);
+
+	string_t keys[64];
+	char buffer[32];
+
+	for (int i = 0; i < 64; ++i) {
+		int len = snprintf(buffer, sizeof(buffer), "key-%d", i % 16);
+		keys[i] = cstr_intern(buffer, (size_t)len);
+	}
+
+	for (int i = 16; i < 64; ++i)
+		assert(keys[i] == keys[i % 16]);
+
+	cstr_intern_stats(&stats);
+	assert(stats.hits >= 48);
+	printf("hits %zu misses %zu hit rate %.2f bytes saved %zu\n", stats.hits, stats.misses, stats.hit_rate, stats.bytes_saved);
+
+	for (int i = 0; i < 64; ++i)
+		cstr_destroy(keys[i]);
+
+	cstr_intern_reset();
+
+	printf("intern tests passed\n");
+	return 0;
+}
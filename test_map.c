@@ -0,0 +1,103 @@
+#include "cstr.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#define KEYS	4096
+
+
+int main(int argc, char **argv)
+{
+	static char names[KEYS][32];
+	static bool present[KEYS];
+	static string_t keys[KEYS];
+
+	for (size_t i = 0; i < KEYS; ++i) {
+		snprintf(names[i], sizeof(names[i]), "key:%zu:%zx", i, i * 2654435761u);
+		keys[i] = cstr_new(names[i]);
+	}
+
+	cstr_map_t *map = cstr_map_new(0, false, 0x5eed);
+
+	for (size_t i = 0; i < KEYS; ++i)
+		assert(cstr_map_insert(map, keys[i], (void *)(i + 1)));
+
+	assert(cstr_map_size(map) == KEYS);
+	assert(!cstr_map_insert(map, keys[7], (void *)7));
+
+	void *value = NULL;
+	assert(cstr_map_find(map, keys[7], &value) && (value == (void *)7));
+	assert(cstr_map_find_n(map, names[42], strlen(names[42]), &value) && (value == (void *)43));
+	assert(!cstr_map_find_n(map, "key:42", 6, NULL));
+
+	for (size_t i = 0; i < KEYS; ++i)
+		present[i] = true;
+
+	for (size_t round = 0; round < 8; ++round) {
+		for (size_t i = round % 2; i < KEYS; i += 2) {
+			if (present[i])
+				assert(cstr_map_erase_n(map, names[i], strlen(names[i])));
+			else
+				assert(cstr_map_insert(map, keys[i], (void *)(i + 1)));
+
+			present[i] = !present[i];
+		}
+
+		size_t expected = 0;
+		for (size_t i = 0; i < KEYS; ++i) {
+			expected += present[i];
+			assert(cstr_map_contains(map, keys[i]) == present[i]);
+		}
+
+		assert(cstr_map_size(map) == expected);
+	}
+
+	size_t cursor = 0, seen = 0;
+	string_t key;
+	while (cstr_map_next(map, &cursor, &key, &value)) {
+		size_t index = (size_t)value - 1;
+		assert(present[index] && (key == keys[index]));
+		++seen;
+	}
+	assert(seen == cstr_map_size(map));
+
+	cstr_map_clear(map);
+	assert(cstr_map_size(map) == 0);
+	assert(!cstr_map_contains(map, keys[0]));
+	cstr_map_destroy(map);
+
+	map = cstr_map_new(16, true, 0);
+
+	string_t owned = cstr_new("owned");
+	assert(cstr_map_insert(map, owned, NULL));
+	cstr_destroy(owned);
+	assert(cstr_map_find_n(map, "owned", 5, NULL));
+
+	cursor = 0;
+	assert(cstr_map_next(map, &cursor, &key, NULL));
+	string_t retained = cstr_retain(key);
+	assert(retained == key);
+	cstr_release(retained);
+
+	assert(cstr_map_insert(map, CSTR_LIT(""), (void *)1));
+	assert(cstr_map_find_n(map, NULL, 0, &value) && (value == (void *)1));
+	assert(cstr_map_erase(map, CSTR_LIT("owned")));
+	assert(cstr_map_size(map) == 1);
+
+	string_t interned = cstr_intern("interned", 8);
+	assert(cstr_map_insert(map, interned, (void *)2));
+	string_t again = cstr_intern("interned", 8);
+	assert(cstr_map_find(map, again, &value) && (value == (void *)2));
+
+	cstr_map_destroy(map);
+	cstr_destroy(interned);
+	cstr_destroy(again);
+	cstr_intern_reset();
+
+	for (size_t i = 0; i < KEYS; ++i)
+		cstr_destroy(keys[i]);
+
+	printf("map tests passed\n");
+	return 0;
+}
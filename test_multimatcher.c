@@ -0,0 +1,67 @@
+#include "cstr.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+
+bool count_match(void *context, size_t id, size_t pos)
+{
+	(void)id;
+	(void)pos;
+	++*(size_t *)context;
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	const char *words[] = { "he", "she", "his", "hers" };
+	cstr_multimatcher_t *matcher = cstr_multimatcher_new(words, NULL, 4);
+
+	string_t text = cstr_new("ushers and his hens");
+	size_t id = 0;
+
+	assert(cstr_multimatcher_find(matcher, text, 0, &id) == 1);
+	assert(id == 1);
+	assert(cstr_multimatcher_matches(matcher, text, 0));
+
+	size_t seen = 0;
+	size_t total = cstr_multimatcher_find_all(matcher, text, 0, count_match, &seen);
+	assert(total == seen);
+	assert(total == 5);
+
+	cstr_multimatcher_destroy(matcher);
+	cstr_destroy(text);
+
+	char bytes[256];
+	const char *patterns[256];
+	size_t lens[256];
+
+	for (size_t i = 0; i < 256; ++i) {
+		bytes[i] = (char)i;
+		patterns[i] = &bytes[i];
+		lens[i] = 1;
+	}
+
+	matcher = cstr_multimatcher_new(patterns, lens, 256);
+
+	char buffer[256];
+	string_t haystack = CSTR_BUFFER(buffer);
+	haystack = cstr_append_n(haystack, "abc", 3);
+
+	assert(cstr_multimatcher_find(matcher, haystack, 0, &id) == 0);
+	assert(id == (unsigned char)'a');
+	assert(cstr_multimatcher_find(matcher, haystack, 2, &id) == 2);
+	assert(id == (unsigned char)'c');
+	assert(cstr_multimatcher_find_all(matcher, haystack, 0, NULL, NULL) == 3);
+
+	haystack[1] = (char)0xFF;
+	assert(cstr_multimatcher_find(matcher, haystack, 1, &id) == 1);
+	assert(id == 0xFF);
+
+	cstr_multimatcher_destroy(matcher);
+	cstr_destroy(haystack);
+
+	printf("multimatcher tests passed\n");
+	return 0;
+}
@@ -0,0 +1,76 @@
+#include "cstr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+
+char *replace_all(const char *text, const char *find_str, size_t find_len, const char *replace_str, size_t replace_len)
+{
+	char *result = malloc(strlen(text) * (replace_len + 1) + 1);
+	size_t write = 0;
+
+	while (*text) {
+		if (strncmp(text, find_str, find_len) == 0) {
+			memcpy(result + write, replace_str, replace_len);
+			write += replace_len;
+			text += find_len;
+		}
+		else
+			result[write++] = *text++;
+	}
+
+	result[write] = '\0';
+	return result;
+}
+
+string_t grown(const char *text)
+{
+	string_t string = cstr_new("");
+	while (cstr_size(string) < 64)
+		string = cstr_append(string, text);
+
+	return string;
+}
+
+int main(int argc, char **argv)
+{
+	string_t s = grown("ab");
+	char *expected = replace_all(s, "a", 1, s + 2, 40);
+	s = cstr_replace_all_n(s, "a", 1, s + 2, 40);
+	assert(strcmp(s, expected) == 0);
+	free(expected);
+	cstr_destroy(s);
+
+	s = grown("xxyy");
+	expected = replace_all(s, "xxyy", 4, s + 1, 3);
+	s = cstr_replace_all_n(s, "xxyy", 4, s + 1, 3);
+	assert(strcmp(s, expected) == 0);
+	free(expected);
+	cstr_destroy(s);
+
+	s = grown("abc-");
+	expected = replace_all(s, s, 2, "Z", 1);
+	s = cstr_replace_all_n(s, s, 2, "Z", 1);
+	assert(strcmp(s, expected) == 0);
+	free(expected);
+	cstr_destroy(s);
+
+	s = grown("abc-");
+	expected = replace_all(s, s + 3, 1, s, 8);
+	s = cstr_replace_all_n(s, s + 3, 1, s, 8);
+	assert(strcmp(s, expected) == 0);
+	free(expected);
+	cstr_destroy(s);
+
+	s = cstr_new("one two one");
+	s = cstr_replace_all(s, "one", "three");
+	assert(strcmp(s, "three two three") == 0);
+	s = cstr_replace_all(s, "three", "1");
+	assert(strcmp(s, "1 two 1") == 0);
+	cstr_destroy(s);
+
+	printf("replace tests passed\n");
+	return 0;
+}
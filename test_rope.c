@@ -0,0 +1,92 @@
+#include "cstr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define MODEL_CAPACITY	(1 << 18)
+
+
+void check(const cstr_rope_t *rope, const char *model, size_t len)
+{
+	assert(cstr_rope_length(rope) == len);
+
+	string_t flat = cstr_rope_flatten(rope);
+	assert(memcmp(flat, model, len) == 0);
+	cstr_destroy(flat);
+
+	cstr_rope_iter_t iter;
+	const char *chunk;
+	size_t chunk_len, offset = 0;
+
+	cstr_rope_iter_init(&iter, rope, 0);
+	while (cstr_rope_iter_next(&iter, &chunk, &chunk_len)) {
+		assert(memcmp(chunk, model + offset, chunk_len) == 0);
+		offset += chunk_len;
+	}
+	assert(offset == len);
+}
+
+int main(int argc, char **argv)
+{
+	static char model[MODEL_CAPACITY];
+	static char text[4096];
+	size_t len = 0;
+
+	srand(1);
+	cstr_rope_t *rope = cstr_rope_new(NULL, 0);
+
+	for (size_t step = 0; step < 2000; ++step) {
+		size_t pos = len ? (size_t)rand() % (len + 1) : 0;
+
+		if ((rand() % 3) || (len < 1024)) {
+			size_t n = (size_t)rand() % sizeof(text);
+			for (size_t i = 0; i < n; ++i)
+				text[i] = (char)('a' + rand() % 26);
+
+			if (len + n >= MODEL_CAPACITY)
+				continue;
+
+			memmove(model + pos + n, model + pos, len - pos);
+			memcpy(model + pos, text, n);
+			len += n;
+			cstr_rope_insert(rope, pos, text, n);
+		}
+		else {
+			size_t n = (size_t)rand() % (len - pos + 1);
+			memmove(model + pos, model + pos + n, len - pos - n);
+			len -= n;
+			cstr_rope_erase(rope, pos, n);
+		}
+
+		if (step % 100 == 0)
+			check(rope, model, len);
+	}
+
+	check(rope, model, len);
+
+	size_t pos = len / 3;
+	assert(cstr_rope_at(rope, pos) == model[pos]);
+	assert(cstr_rope_find(rope, model + pos, 0, 64) <= pos);
+
+	cstr_rope_t *copy = cstr_rope_clone(rope);
+	cstr_rope_t *right = cstr_rope_split(rope, pos);
+	check(rope, model, pos);
+	check(right, model + pos, len - pos);
+
+	cstr_rope_concat(rope, right);
+	check(rope, model, len);
+	check(copy, model, len);
+
+	cstr_rope_t *middle = cstr_rope_substr(copy, 10, 500);
+	check(middle, model + 10, 500);
+
+	cstr_rope_destroy(middle);
+	cstr_rope_destroy(right);
+	cstr_rope_destroy(copy);
+	cstr_rope_destroy(rope);
+
+	printf("rope tests passed\n");
+	return 0;
+}